@@ -0,0 +1,142 @@
+// Compression ratio/throughput benchmark of the block codec (@see aurora::LogBlock).
+//
+// Build with `-DAURORA_BUILD_BENCHMARKS=ON` and run:
+//   <build>/aurora-bench-compression [plain log file]
+//
+// Without a file, a synthetic log resembling plain Aurora output is used. The input is split into blocks
+// at record boundaries, like compressed targets do, for each block size.
+
+#include <aurora/LogBlock.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <cstdio>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <print>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace aurora;
+
+
+namespace {
+
+std::string syntheticLog(std::size_t size) {
+	constexpr std::string_view kLevels[] = { "DEBUG", "INFO ", "WARN ", "ERROR" };
+	constexpr std::string_view kThreads[] = { "Main", "Render", "Network", "Audio" };
+	constexpr std::string_view kSources[] = { "[Net] | ", "[Render] | ", "[Assets] | ", "" };
+
+	std::mt19937 rng(42u);
+	std::string ret;
+	ret.reserve(size + 256u);
+
+	for (std::uint64_t ms = 0u; ret.size() < size; ms += rng() % 50u) {
+		auto source = kSources[rng() % std::size(kSources)];
+		std::format_to(
+			std::back_inserter(ret),
+			"{:02}:{:02}:{:02}.{:03} | [{}] {} | {}",
+			ms / 3'600'000u % 24u, ms / 60'000u % 60u, ms / 1000u % 60u, ms % 1000u,
+			kThreads[rng() % std::size(kThreads)], kLevels[rng() % std::size(kLevels)], source
+		);
+
+		switch (rng() % 3u) {
+			case 0u:
+				std::format_to(std::back_inserter(ret), "Received {} bytes from peer {}.\n", rng() % 65536u, rng() % 16u);
+				break;
+			case 1u:
+				std::format_to(std::back_inserter(ret), "Frame {} took {:.2f} ms\n", ms / 16u, (rng() % 2000u) / 100.0);
+				break;
+			default:
+				std::format_to(std::back_inserter(ret), "Loaded 'assets/textures/{:04x}.png' ({} KB)\n", rng() % 4096u, rng() % 1024u);
+				break;
+		}
+	}
+
+	return ret;
+}
+
+// splits @p log into blocks of at least @p blockSize bytes, ending on a newline
+std::vector<std::string_view> splitBlocks(std::string_view log, std::size_t blockSize) {
+	std::vector<std::string_view> ret;
+
+	while (!log.empty()) {
+		auto end = log.size() <= blockSize ? std::string_view::npos : log.find('\n', blockSize - 1u);
+		end = end == std::string_view::npos ? log.size() : end + 1u;
+
+		ret.push_back(log.substr(0u, end));
+		log.remove_prefix(end);
+	}
+
+	return ret;
+}
+
+} // namespace
+
+
+int main(int argc, char** argv) {
+	namespace ch = std::chrono;
+
+	std::string log;
+	if (argc > 1) {
+		std::ifstream F(argv[1], std::ios::binary);
+		log.assign(std::istreambuf_iterator<char>(F), {});
+		if (log.empty()) {
+			std::println(stderr, "Failed to read '{}'.", argv[1]);
+			return 1;
+		}
+	} else {
+		log = syntheticLog(64u << 20u);
+	}
+
+	std::println("Input: {:.1f} MB", log.size() / 1e6);
+	std::println("{:>8} {:>8} {:>14} {:>14}", "block", "ratio", "compress", "decompress");
+
+	for (std::size_t kilobytes : { 4u, 16u, 64u, 256u, 1024u }) {
+		auto blocks = splitBlocks(log, kilobytes * 1024u);
+
+		std::vector<std::string> encoded(blocks.size());
+		std::size_t encodedSize = 0u;
+
+		auto compressStart = ch::steady_clock::now();
+		for (std::size_t i = 0u; i < blocks.size(); ++i) {
+			LogBlock::encode({}, blocks[i], encoded[i]);
+			encodedSize += encoded[i].size();
+		}
+		ch::duration<double> compressTime = ch::steady_clock::now() - compressStart;
+
+		std::string records;
+		bool intact = true;
+		auto decode = [&encoded, &records](std::size_t i) {
+			LogBlock::Header header;
+			std::memcpy(&header, encoded[i].data(), sizeof(header));
+
+			return LogBlock::decode(header, std::string_view(encoded[i]).substr(sizeof(header)), records);
+		};
+
+		auto decompressStart = ch::steady_clock::now();
+		for (std::size_t i = 0u; i < blocks.size(); ++i)
+			intact &= decode(i);
+		ch::duration<double> decompressTime = ch::steady_clock::now() - decompressStart;
+
+		// verified outside of the timed loop
+		for (std::size_t i = 0u; i < blocks.size() && intact; ++i)
+			intact = decode(i) && records == blocks[i];
+
+		if (!intact) {
+			std::println(stderr, "Round trip failed with {} KB blocks.", kilobytes);
+			return 1;
+		}
+
+		std::println(
+			"{:>5} KB {:>8.2f} {:>9.0f} MB/s {:>9.0f} MB/s",
+			kilobytes, static_cast<double>(log.size()) / encodedSize,
+			log.size() / 1e6 / compressTime.count(), log.size() / 1e6 / decompressTime.count()
+		);
+	}
+
+	return 0;
+}
\ No newline at end of file
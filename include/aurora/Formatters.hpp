@@ -0,0 +1,99 @@
+#pragma once
+
+#include <format>
+#include <string_view>
+#include <ranges>
+#include <cstddef>
+
+
+namespace aurora {
+
+/**
+ * @brief Bytes formatted as a hex dump: offset, 16 bytes in hex and their printable characters per line
+ * (e.g. `00000000  48 65 6c 6c 6f 0a 00 01  ...  |Hello...|`). Made with @ref aurora::hexdump
+ *
+ */
+struct HexDump final {
+	std::string_view data;
+};
+/**
+ * @brief A string formatted up to a maximum size, followed by the number of omitted bytes
+ * (e.g. `Hello... [+1234 bytes]`). Made with @ref aurora::truncated
+ *
+ */
+struct Truncated final {
+	std::string_view data;
+	std::size_t maxSize;
+};
+/**
+ * @brief Bytes formatted as printable ASCII, with C-style escapes for the rest
+ * (e.g. `GET /\r\n\x00`). Made with @ref aurora::escaped
+ *
+ */
+struct Escaped final {
+	std::string_view data;
+};
+
+namespace detail {
+
+template <std::ranges::contiguous_range Range>
+[[nodiscard]] std::string_view asBytes(Range const& range) noexcept {
+	return {
+		reinterpret_cast<char const*>(std::ranges::data(range)),
+		std::ranges::size(range) * sizeof(std::ranges::range_value_t<Range>)
+	};
+}
+
+} // namespace detail
+
+/**
+ * @brief Formats bytes as a hex dump (@see aurora::HexDump)
+ *
+ * @param range Contiguous range of bytes (or any trivially copyable values). Has to outlive the formatting
+ * @return Formattable wrapper
+ */
+template <std::ranges::contiguous_range Range>
+[[nodiscard]] HexDump hexdump(Range const& range) noexcept {
+	return { detail::asBytes(range) };
+}
+/**
+ * @brief Formats a string up to a maximum size (@see aurora::Truncated)
+ *
+ * @param str String to format. Has to outlive the formatting
+ * @param maxSize Maximum number of bytes of @p str to format
+ * @return Formattable wrapper
+ */
+[[nodiscard]] inline Truncated truncated(std::string_view str, std::size_t maxSize) noexcept {
+	return { str, maxSize };
+}
+/**
+ * @brief Formats bytes as escaped ASCII (@see aurora::Escaped)
+ *
+ * @param range Contiguous range of bytes (or any trivially copyable values). Has to outlive the formatting
+ * @return Formattable wrapper
+ */
+template <std::ranges::contiguous_range Range>
+[[nodiscard]] Escaped escaped(Range const& range) noexcept {
+	return { detail::asBytes(range) };
+}
+
+} // namespace aurora
+
+
+template <>
+struct std::formatter<aurora::HexDump> {
+	constexpr auto parse(std::format_parse_context& ctx) { return ctx.begin(); }
+	std::format_context::iterator format(aurora::HexDump const& hexDump, std::format_context& ctx) const;
+};
+
+template <>
+struct std::formatter<aurora::Truncated> {
+	constexpr auto parse(std::format_parse_context& ctx) { return ctx.begin(); }
+	std::format_context::iterator format(aurora::Truncated const& truncated, std::format_context& ctx) const;
+};
+
+template <>
+struct std::formatter<aurora::Escaped> {
+	constexpr auto parse(std::format_parse_context& ctx) { return ctx.begin(); }
+	std::format_context::iterator format(aurora::Escaped const& escaped, std::format_context& ctx) const;
+};
\ No newline at end of file
@@ -0,0 +1,337 @@
+#pragma once
+
+#include <aurora/log.hpp>
+
+#include <array>
+#include <string>
+#include <string_view>
+#include <istream>
+#include <optional>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+
+
+namespace aurora {
+
+/**
+ * @brief Block format of compressed targets (@see aurora::TargetManager::TargetConfig::compressed).
+ * Header-only, so tools can decode blocks without linking Aurora
+ *
+ * @details A compressed log file is a sequence of independently decodable blocks, each one a header followed by its payload.
+ * Headers carry the sizes of the block, so readers can skip from block to block without decoding.
+ * Payloads use a small LZ77 codec (LZ4-like sequences of literals and back-references within the block);
+ * blocks that don't shrink are stored as is
+ *
+ */
+class LogBlock final {
+public:
+	// ..............
+	LogBlock() = delete;
+	LogBlock(LogBlock const&) = delete;
+	LogBlock& operator=(LogBlock const&) = delete;
+	LogBlock(LogBlock&&) = delete;
+	LogBlock& operator=(LogBlock&&) = delete;
+	~LogBlock() = delete;
+
+	/**
+	 * @brief Magic bytes at the start of every block
+	 *
+	 */
+	static constexpr char kMagic[4] = { 'A', 'L', 'Z', '1' };
+	/**
+	 * @brief Maximum size of the records of a block
+	 *
+	 * @details Sizes are stored in 32 bits; the limit stays well below that, so encoded payloads always fit as well
+	 *
+	 */
+	static constexpr std::uint32_t kMaxRawSize = 64u * 1024u * 1024u;
+
+	/**
+	 * @brief An enum, containing all available payload codecs
+	 *
+	 */
+	enum class Codec : std::uint8_t {
+		Stored,
+		LZ
+	};
+
+	/**
+	 * @brief Header of a block
+	 *
+	 */
+	struct Header final {
+		char magic[4];
+		Codec codec;
+		// bit `1 << LogLevel` is set for every log level present in the block
+		std::uint8_t levelMask;
+		std::uint8_t reserved[2];
+		std::uint32_t recordCount;
+		// size of the records before/after encoding
+		std::uint32_t rawSize;
+		std::uint32_t storedSize;
+		// FNV-1a of the records
+		std::uint32_t checksum;
+		// Unix time of the first/last record in nanoseconds
+		std::int64_t firstTime;
+		std::int64_t lastTime;
+	};
+	static_assert(sizeof(Header) == 40u);
+
+	/**
+	 * @brief Encodes a block
+	 *
+	 * @param header Header of the block with the record count, log levels and time range filled in. The rest is filled in here
+	 * @param records Records of the block
+	 * @param out String to store the header and the payload in. Overwritten
+	 */
+	static void encode(Header header, std::string_view records, std::string& out) noexcept {
+		header = storedHeader(header, records);
+
+		out.assign(sizeof(Header), '\0');
+		compress(records, out);
+
+		if (out.size() - sizeof(Header) >= records.size()) {
+			out.resize(sizeof(Header));
+			out.append(records);
+		} else {
+			header.codec = Codec::LZ;
+			header.storedSize = static_cast<std::uint32_t>(out.size() - sizeof(Header));
+		}
+
+		std::memcpy(out.data(), &header, sizeof(Header));
+
+		return;
+	}
+
+	/**
+	 * @brief Completes the header of a block stored as is, i.e. followed by @p records themselves.
+	 * Doesn't allocate, so it's usable from signal handlers
+	 *
+	 * @param header Header of the block with the record count, log levels and time range filled in
+	 * @param records Records of the block
+	 * @return The completed header
+	 */
+	[[nodiscard]] static Header storedHeader(Header header, std::string_view records) noexcept {
+		std::memcpy(header.magic, kMagic, sizeof(kMagic));
+		header.codec = Codec::Stored;
+		header.rawSize = static_cast<std::uint32_t>(records.size());
+		header.storedSize = header.rawSize;
+		header.checksum = checksum(records);
+
+		return header;
+	}
+
+	/**
+	 * @brief Reads the next block header of a stream
+	 *
+	 * @param stream Stream positioned at a block
+	 * @return The header or `std::nullopt` at the end of the stream or on an invalid header
+	 */
+	[[nodiscard]] static std::optional<Header> readHeader(std::istream& stream) noexcept {
+		Header header;
+		if (!stream.read(reinterpret_cast<char*>(&header), sizeof(header)))
+			return std::nullopt;
+		if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0)
+			return std::nullopt;
+
+		return header;
+	}
+
+	/**
+	 * @brief Decodes the payload of a block
+	 *
+	 * @param header Header of the block
+	 * @param payload Payload of the block (`header.storedSize` bytes following the header)
+	 * @param records String to store the records in. Overwritten
+	 * @return Boolean, indicating that the block is intact
+	 */
+	[[nodiscard]] static bool decode(Header const& header, std::string_view payload, std::string& records) noexcept {
+		if (payload.size() != header.storedSize)
+			return false;
+
+		switch (header.codec) {
+			case Codec::Stored:
+				records.assign(payload);
+				break;
+
+			case Codec::LZ:
+				if (!decompress(payload, header.rawSize, records))
+					return false;
+				break;
+
+			default:
+				return false;
+		}
+
+		return records.size() == header.rawSize && checksum(records) == header.checksum;
+	}
+
+	/**
+	 * @brief Compresses data with the block codec, appending the result
+	 *
+	 * @param in Data to compress
+	 * @param out String to append the compressed data to
+	 */
+	static void compress(std::string_view in, std::string& out) noexcept {
+		std::array<std::uint32_t, 1u << kHashBits> table{};
+		std::size_t anchor = 0u;
+		std::size_t pos = 0u;
+
+		// positions inside matches aren't hashed, which trades a bit of ratio for speed
+		while (pos + kMinMatch <= in.size()) {
+			auto word = read32(in, pos);
+			auto& slot = table[hash(word)];
+			std::size_t candidate = slot;
+			slot = static_cast<std::uint32_t>(pos);
+
+			if (candidate >= pos || pos - candidate > 0xFFFFu || read32(in, candidate) != word) {
+				++pos;
+				continue;
+			}
+
+			auto length = kMinMatch;
+			while (pos + length < in.size() && in[candidate + length] == in[pos + length])
+				++length;
+
+			writeSequence(in.substr(anchor, pos - anchor), pos - candidate, length, out);
+			pos += length;
+			anchor = pos;
+		}
+
+		writeSequence(in.substr(anchor), 0u, 0u, out);
+
+		return;
+	}
+
+	/**
+	 * @brief Decompresses data of the block codec
+	 *
+	 * @param in Compressed data
+	 * @param rawSize Size of the decompressed data
+	 * @param out String to store the decompressed data in. Overwritten
+	 * @return Boolean, indicating that @p in is valid and decompresses to exactly @p rawSize bytes
+	 */
+	[[nodiscard]] static bool decompress(std::string_view in, std::size_t rawSize, std::string& out) noexcept {
+		out.resize(rawSize);
+		auto dst = out.data();
+		std::size_t ip = 0u;
+		std::size_t op = 0u;
+
+		auto readLength = [&in, &ip](std::size_t& length) {
+			std::uint8_t byte;
+			do {
+				if (ip >= in.size())
+					return false;
+
+				byte = static_cast<std::uint8_t>(in[ip++]);
+				length += byte;
+			} while (byte == 0xFFu);
+
+			return true;
+		};
+
+		while (ip < in.size()) {
+			auto token = static_cast<std::uint8_t>(in[ip++]);
+
+			std::size_t literals = token >> 4u;
+			if (literals == 0xFu && !readLength(literals))
+				return false;
+			if (literals > in.size() - ip || literals > rawSize - op)
+				return false;
+
+			std::memcpy(dst + op, in.data() + ip, literals);
+			ip += literals;
+			op += literals;
+
+			// the last sequence has no match
+			if (ip == in.size())
+				break;
+			if (in.size() - ip < 2u)
+				return false;
+
+			std::size_t offset = static_cast<std::uint8_t>(in[ip]) | static_cast<std::uint8_t>(in[ip + 1u]) << 8u;
+			ip += 2u;
+
+			std::size_t length = token & 0xFu;
+			if (length == 0xFu && !readLength(length))
+				return false;
+			length += kMinMatch;
+
+			if (offset == 0u || offset > op || length > rawSize - op)
+				return false;
+
+			// overlapping matches repeat the last `offset` bytes
+			if (offset >= length) {
+				std::memcpy(dst + op, dst + op - offset, length);
+				op += length;
+			} else {
+				for (std::size_t i = 0u; i < length; ++i, ++op)
+					dst[op] = dst[op - offset];
+			}
+		}
+
+		return op == rawSize;
+	}
+
+	/**
+	 * @brief FNV-1a checksum of block records
+	 *
+	 * @param data Data to hash
+	 * @return The checksum
+	 */
+	[[nodiscard]] static std::uint32_t checksum(std::string_view data) noexcept {
+		std::uint32_t ret = 2166136261u;
+		for (auto c : data) {
+			ret ^= static_cast<std::uint8_t>(c);
+			ret *= 16777619u;
+		}
+
+		return ret;
+	}
+
+private:
+	static constexpr std::size_t kMinMatch = 4u;
+	static constexpr std::uint32_t kHashBits = 14u;
+
+	[[nodiscard]] static std::uint32_t read32(std::string_view in, std::size_t pos) noexcept {
+		std::uint32_t ret;
+		std::memcpy(&ret, in.data() + pos, sizeof(ret));
+
+		return ret;
+	}
+
+	[[nodiscard]] static std::uint32_t hash(std::uint32_t word) noexcept {
+		return (word * 2654435761u) >> (32u - kHashBits);
+	}
+
+	// a sequence is a token, literals and a back-reference (none if @p length is 0)
+	static void writeSequence(std::string_view literals, std::size_t offset, std::size_t length, std::string& out) noexcept {
+		auto writeLength = [&out](std::size_t length) {
+			for (; length >= 0xFFu; length -= 0xFFu)
+				out.push_back(static_cast<char>(0xFFu));
+			out.push_back(static_cast<char>(length));
+		};
+
+		auto matchLength = length == 0u ? 0u : length - kMinMatch;
+		out.push_back(static_cast<char>(
+			std::min<std::size_t>(literals.size(), 0xFu) << 4u | std::min<std::size_t>(matchLength, 0xFu)
+		));
+
+		if (literals.size() >= 0xFu)
+			writeLength(literals.size() - 0xFu);
+		out.append(literals);
+
+		if (length == 0u)
+			return;
+
+		out.push_back(static_cast<char>(offset & 0xFFu));
+		out.push_back(static_cast<char>(offset >> 8u));
+		if (matchLength >= 0xFu)
+			writeLength(matchLength - 0xFu);
+
+		return;
+	}
+};
+
+} // namespace aurora
\ No newline at end of file
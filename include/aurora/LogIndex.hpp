@@ -0,0 +1,87 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <fstream>
+#include <cstring>
+#include <cstdint>
+
+
+namespace aurora {
+
+/**
+ * @brief Sidecar index of a log file (@see aurora::TargetManager::setIndexInterval).
+ * Header-only, so tools can read indexes without linking Aurora
+ *
+ * @details An index is a sequence of fixed-size entries, each one describing a contiguous block of records in the log file:
+ * its byte range, time range and the log levels it contains
+ *
+ */
+class LogIndex final {
+public:
+	// ..............
+	LogIndex() = delete;
+	LogIndex(LogIndex const&) = delete;
+	LogIndex& operator=(LogIndex const&) = delete;
+	LogIndex(LogIndex&&) = delete;
+	LogIndex& operator=(LogIndex&&) = delete;
+	~LogIndex() = delete;
+
+	/**
+	 * @brief Magic bytes at the start of every index file
+	 *
+	 */
+	static constexpr char kMagic[8] = { 'A', 'U', 'R', 'I', 'D', 'X', '1', '\n' };
+
+	/**
+	 * @brief A block of records
+	 *
+	 */
+	struct Entry final {
+		// Unix time of the first/last record in nanoseconds
+		std::int64_t firstTime;
+		std::int64_t lastTime;
+		// byte range of the block in the log file
+		std::uint64_t offset;
+		std::uint64_t size;
+		std::uint32_t recordCount;
+		// bit `1 << LogLevel` is set for every log level present in the block
+		std::uint8_t levelMask;
+		std::uint8_t reserved[3];
+	};
+	static_assert(sizeof(Entry) == 40u);
+
+	/**
+	 * @brief Gets the index path of a log file
+	 *
+	 * @param pathToAFile Path to a log file
+	 * @return Path to its index
+	 */
+	[[nodiscard]] static std::string pathFor(std::string_view pathToAFile) noexcept {
+		return std::string(pathToAFile).append(".idx");
+	}
+
+	/**
+	 * @brief Reads all entries of an index
+	 *
+	 * @param pathToAnIndex Path to an index file
+	 * @return Entries in file order, or an empty vector if the index is missing or invalid
+	 */
+	[[nodiscard]] static std::vector<Entry> read(std::string_view pathToAnIndex) noexcept {
+		std::vector<Entry> ret;
+
+		std::ifstream F(std::string(pathToAnIndex), std::ios::binary);
+		char magic[sizeof(kMagic)];
+		if (!F.read(magic, sizeof(magic)) || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0)
+			return ret;
+
+		Entry entry;
+		while (F.read(reinterpret_cast<char*>(&entry), sizeof(entry)))
+			ret.push_back(entry);
+
+		return ret;
+	}
+};
+
+} // namespace aurora
\ No newline at end of file
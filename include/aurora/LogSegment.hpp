@@ -0,0 +1,156 @@
+#pragma once
+
+#include <aurora/log.hpp>
+
+#include <vector>
+#include <queue>
+#include <span>
+#include <string>
+#include <fstream>
+#include <utility>
+#include <functional>
+#include <cstring>
+#include <cstdint>
+
+
+namespace aurora {
+
+/**
+ * @brief Per-thread segment file format (@see aurora::TargetManager::setThreadSegmentsEnabled).
+ * Header-only, so tools can read and merge segments without linking Aurora
+ *
+ * @details A segment is the magic followed by framed records: a fixed-size header with the time, size and log level of the record,
+ * then the plain record itself. Exact record times make it possible to merge segments of different threads into a single ordered log
+ *
+ */
+class LogSegment final {
+public:
+	// ..............
+	LogSegment() = delete;
+	LogSegment(LogSegment const&) = delete;
+	LogSegment& operator=(LogSegment const&) = delete;
+	LogSegment(LogSegment&&) = delete;
+	LogSegment& operator=(LogSegment&&) = delete;
+	~LogSegment() = delete;
+
+	/**
+	 * @brief Magic bytes at the start of every segment file
+	 *
+	 */
+	static constexpr char kMagic[8] = { 'A', 'U', 'R', 'S', 'E', 'G', '1', '\n' };
+	/**
+	 * @brief Extension of segment files
+	 *
+	 */
+	static constexpr std::string_view kExtension = ".seg";
+
+	/**
+	 * @brief Header of a record
+	 *
+	 */
+	struct RecordHeader final {
+		// Unix time of the record in nanoseconds
+		std::int64_t time;
+		std::uint32_t size;
+		log::LogLevel logLevel;
+		std::uint8_t reserved[3];
+	};
+	static_assert(sizeof(RecordHeader) == 16u);
+
+	/**
+	 * @brief A record read from a segment
+	 *
+	 */
+	struct Record final {
+		RecordHeader header;
+		std::string text;
+	};
+
+	/**
+	 * @brief Sequential reader of a segment file
+	 *
+	 */
+	class Reader final {
+	public:
+		/**
+		 * @brief Opens a segment
+		 *
+		 * @param pathToASegment Path to a segment file
+		 */
+		explicit Reader(std::string_view pathToASegment) noexcept
+			: m_file(std::string(pathToASegment), std::ios::binary) {
+			char magic[sizeof(kMagic)];
+			m_valid = m_file.read(magic, sizeof(magic)) && std::memcmp(magic, kMagic, sizeof(kMagic)) == 0;
+		}
+
+		/**
+		 * @brief Gets whether the file is a readable segment
+		 *
+		 * @return Current value
+		 */
+		[[nodiscard]] bool isValid() const noexcept { return m_valid; }
+
+		/**
+		 * @brief Reads the next record
+		 *
+		 * @param record Record to read into. Overwritten
+		 * @return Boolean, indicating that a whole record was read; `false` at the end of the segment or on a truncated record
+		 */
+		bool next(Record& record) noexcept {
+			if (!m_valid || !m_file.read(reinterpret_cast<char*>(&record.header), sizeof(record.header)))
+				return false;
+
+			record.text.resize(record.header.size);
+			return static_cast<bool>(m_file.read(record.text.data(), record.header.size));
+		}
+
+	private:
+		// Fields
+		std::ifstream m_file;
+		bool m_valid;
+	};
+
+	/**
+	 * @brief Merges segments into a single sequence of records ordered by time (k-way merge)
+	 *
+	 * @details Records within a segment are expected to be in time order, which holds for segments written by Aurora
+	 *
+	 * @param paths Paths to segment files
+	 * @param callback Called with every record (`void(Record const&)`), oldest first. Records with equal times keep the order of @p paths
+	 * @return Number of files that aren't readable segments
+	 */
+	template <typename Callback>
+	static std::size_t merge(std::span<std::string const> paths, Callback&& callback) noexcept {
+		std::size_t invalid = 0u;
+		std::vector<Reader> readers;
+		std::vector<Record> heads(paths.size());
+		readers.reserve(paths.size());
+
+		// (time, segment) pairs of the current head of every segment, the oldest on top
+		using Head = std::pair<std::int64_t, std::size_t>;
+		std::priority_queue<Head, std::vector<Head>, std::greater<Head>> queue;
+
+		for (std::size_t i = 0u; i < paths.size(); ++i) {
+			auto& reader = readers.emplace_back(paths[i]);
+
+			if (!reader.isValid())
+				++invalid;
+			else if (reader.next(heads[i]))
+				queue.emplace(heads[i].header.time, i);
+		}
+
+		while (!queue.empty()) {
+			auto segment = queue.top().second;
+			queue.pop();
+
+			callback(std::as_const(heads[segment]));
+
+			if (readers[segment].next(heads[segment]))
+				queue.emplace(heads[segment].header.time, segment);
+		}
+
+		return invalid;
+	}
+};
+
+} // namespace aurora
\ No newline at end of file
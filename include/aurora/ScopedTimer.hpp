@@ -0,0 +1,80 @@
+#pragma once
+
+#include <aurora/log.hpp>
+#include <aurora/singletons/TraceManager.hpp>
+
+#include <string>
+#include <cstdint>
+
+
+namespace aurora {
+
+/**
+ * @brief RAII timer/trace span.
+ * Measures the time between its construction and destruction (or @ref aurora::ScopedTimer::stop)
+ *
+ * @details Results are either logged (e.g. `... DEBUG | [Render] | took 1.23 ms`)
+ * and/or recorded as a span in the trace target (@see aurora::TraceManager)
+ *
+ */
+class ScopedTimer final {
+public:
+	/**
+	 * @brief Where the measured span should be emitted to
+	 *
+	 */
+	enum class Output : std::uint8_t {
+		Log,
+		Trace,
+		Both
+	};
+
+	/**
+	 * @brief Starts the timer
+	 *
+	 * @param name Name of the span. Used as the source specifier in logs
+	 * @param output Where the span should be emitted to
+	 * @param logLevel Log level to log the span at. Only matters if @p output is not `Output::Trace`
+	 */
+	explicit ScopedTimer(
+		std::string_view name,
+		Output output = Output::Log,
+		log::LogLevel logLevel = log::LogLevel::Debug
+	) noexcept
+		: m_name(name)
+		, m_output(output)
+		, m_logLevel(logLevel)
+		, m_begin(TraceManager::Clock::now()) {}
+
+	ScopedTimer(ScopedTimer const&) = delete;
+	ScopedTimer& operator=(ScopedTimer const&) = delete;
+	ScopedTimer(ScopedTimer&&) = delete;
+	ScopedTimer& operator=(ScopedTimer&&) = delete;
+
+	~ScopedTimer() noexcept { this->stop(); }
+
+	/**
+	 * @brief Stops the timer and emits the span. Does nothing if the timer is already stopped
+	 *
+	 */
+	void stop() noexcept;
+	/**
+	 * @brief Gets the time elapsed since the timer has started
+	 *
+	 * @return Elapsed time. Stays the same after the timer has been stopped
+	 */
+	[[nodiscard]] TraceManager::Clock::duration elapsed() const noexcept {
+		return (m_stopped ? m_end : TraceManager::Clock::now()) - m_begin;
+	}
+
+private:
+	// Fields
+	std::string m_name;
+	Output m_output;
+	log::LogLevel m_logLevel;
+	bool m_stopped = false;
+	TraceManager::Clock::time_point m_begin;
+	TraceManager::Clock::time_point m_end{};
+};
+
+} // namespace aurora
\ No newline at end of file
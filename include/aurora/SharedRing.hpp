@@ -0,0 +1,144 @@
+#pragma once
+
+#include <aurora/log.hpp>
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <chrono>
+#include <cstdint>
+
+
+namespace aurora {
+
+namespace test { struct Access; }
+
+/**
+ * @brief A ring of log records in POSIX shared memory.
+ * Any number of processes may push records; a single collector pops them
+ *
+ * @details Slots are reserved lock-free, so producers never wait on each other or on file I/O.
+ * Records longer than the slot size are truncated. When the ring is full, records are dropped and counted.
+ * A slot that a producer reserved but didn't fill within half a second (e.g. the producer died) is skipped and counted as dropped;
+ * a producer stalled for longer than that may garble one record of a later lap.
+ * Only available on POSIX systems
+ *
+ */
+class SharedRing final {
+public:
+	/**
+	 * @brief Creates a new ring or takes over one with the same name
+	 *
+	 * @details A ring left by a collector that didn't detach (e.g. crashed) is taken over if it has the same slot count and size,
+	 * so its producers stay attached and its records are still collected. Otherwise the old ring is retired (@see aurora::SharedRing::isRetired)
+	 * and replaced. A ring whose collecting process is still running is neither taken over nor replaced
+	 *
+	 * @param name Name of the shared memory object (e.g. `/aurora`)
+	 * @param slotCount Number of slots. Rounded up to a power of two
+	 * @param slotSize Maximum size of a single record in bytes
+	 * @return The ring or `nullptr` if the creation failed or another process collects the ring
+	 */
+	[[nodiscard]] static std::unique_ptr<SharedRing> create(
+		std::string_view name,
+		std::uint32_t slotCount,
+		std::uint32_t slotSize
+	) noexcept;
+	/**
+	 * @brief Opens an existing ring, created by a collector
+	 *
+	 * @param name Name of the shared memory object (e.g. `/aurora`)
+	 * @return The ring or `nullptr` if the ring doesn't exist or is incompatible
+	 */
+	[[nodiscard]] static std::unique_ptr<SharedRing> open(std::string_view name) noexcept;
+	/**
+	 * @brief Opens the ring that replaced this one, without logging failures
+	 *
+	 * @return The new ring or `nullptr` if there is none (yet)
+	 */
+	[[nodiscard]] std::unique_ptr<SharedRing> reopen() const noexcept;
+
+	SharedRing(SharedRing const&) = delete;
+	SharedRing& operator=(SharedRing const&) = delete;
+	SharedRing(SharedRing&&) = delete;
+	SharedRing& operator=(SharedRing&&) = delete;
+
+	~SharedRing() noexcept;
+
+private:
+	SharedRing(std::string name, int fd, void* memory, std::size_t size, bool owner) noexcept;
+
+	[[nodiscard]] static std::unique_ptr<SharedRing> attach(std::string path, bool quiet) noexcept;
+
+public:
+	/**
+	 * @brief Metadata of a popped record
+	 *
+	 */
+	struct Entry final {
+		log::LogLevel logLevel;
+		std::chrono::system_clock::time_point time;
+		// process that pushed the record
+		std::int32_t pid;
+	};
+
+	/**
+	 * @brief Pushes a record into the ring. Safe to call from any thread of any process
+	 *
+	 * @param logLevel Log level of the record
+	 * @param time Time of the record
+	 * @param record Record to push
+	 * @return Boolean, indicating that the record wasn't dropped. Records pushed to a retired ring are dropped without being counted
+	 */
+	bool push(log::LogLevel logLevel, std::chrono::system_clock::time_point time, std::string_view record) noexcept;
+	/**
+	 * @brief Pops the oldest record from the ring. Must only be called by a single collector
+	 *
+	 * @details Skips a slot that stayed reserved without a record for too long (@see aurora::SharedRing)
+	 *
+	 * @param record String to store the record in. Overwritten
+	 * @return Metadata of the record or `std::nullopt` if the ring is empty
+	 */
+	std::optional<Entry> pop(std::string& record) noexcept;
+
+	/**
+	 * @brief Gets the number of records dropped by all producers because the ring was full
+	 *
+	 * @return Current value
+	 */
+	[[nodiscard]] std::uint64_t getDroppedCount() const noexcept;
+	/**
+	 * @brief Gets whether the collector closed the ring or replaced it with a new one. Producers should @ref aurora::SharedRing::reopen it
+	 *
+	 * @return Current value
+	 */
+	[[nodiscard]] bool isRetired() const noexcept;
+	/**
+	 * @brief Gets the name of the shared memory object
+	 *
+	 * @return Name of the ring
+	 */
+	[[nodiscard]] std::string_view getName() const noexcept { return m_name; }
+
+private:
+	struct Header;
+	struct Slot;
+
+	friend struct test::Access;
+
+	[[nodiscard]] Header& header() const noexcept;
+	[[nodiscard]] Slot& slot(std::uint64_t position) const noexcept;
+	// @return Slot for the record at @p position or `nullptr` if the ring is full
+	[[nodiscard]] Slot* reserve(std::uint64_t& position) noexcept;
+
+	// Fields
+	std::string m_name;
+	int m_fd;
+	void* m_memory;
+	std::size_t m_size;
+	bool m_owner;
+	std::uint64_t m_tail = 0u;
+	// since when the slot at m_tail is reserved without a record
+	std::optional<std::chrono::steady_clock::time_point> m_stalledSince{};
+};
+
+} // namespace aurora
\ No newline at end of file
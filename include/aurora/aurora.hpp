@@ -2,5 +2,8 @@
 
 
 #include "log.hpp" // IWYU pragma: keep
+#include "Formatters.hpp" // IWYU pragma: keep
+#include "ScopedTimer.hpp" // IWYU pragma: keep
+#include "SharedRing.hpp" // IWYU pragma: keep
 
 #include "singletons/singletons.hpp" // IWYU pragma: keep
\ No newline at end of file
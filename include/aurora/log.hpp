@@ -1,12 +1,12 @@
 #pragma once
 
-#include <aurora/singletons/TargetManager.hpp>
-
 #include <variant>
-#include <print>
-#include <iostream>
-#include <regex>
-#include <fstream>
+#include <format>
+#include <string>
+#include <string_view>
+#include <chrono>
+#include <utility>
+#include <cstdint>
 
 
 namespace aurora {
@@ -47,6 +47,8 @@ public:
 	/**
 	 * @brief Sets logging level for console output. `LogLevel::Debug` by default
 	 * 
+	 * @details Over a throughput budget, the effective level may be raised for a while (@see aurora::LoadManager)
+	 * 
 	 * @param logLevel Logging level
 	 */
 	static void setLogLevel(LogLevel logLevel) noexcept { s_logLevel = logLevel; }
@@ -59,6 +61,9 @@ public:
 	/**
 	 * @brief Sets logging level for file output. `LogLevel::Info` by default
 	 * 
+	 * @details Targets with a level of their own don't follow it (@see aurora::TargetManager::TargetConfig::logLevel).
+	 * Over a throughput budget, the effective level may be raised for a while (@see aurora::LoadManager)
+	 * 
 	 * @param logLevel Logging level
 	 */
 	static void setFileLogLevel(LogLevel logLevel) noexcept { s_fileLogLevel = logLevel; }
@@ -127,7 +132,8 @@ private:
 
 // Logging functions
 private:
-	using LogStates = std::pair<bool, bool>;
+	// console output enabled, bitmask of file formats to render (@see aurora::TargetManager::Format)
+	using LogStates = std::pair<bool, std::uint8_t>;
 	static LogStates statesForLevel(LogLevel logLevel) noexcept;
 	#define IMPL_CHECK_STATES(_logLevel) if (auto states = statesForLevel((_logLevel)); states.first || states.second)
 
@@ -141,7 +147,7 @@ public:
 	template <typename ...Args>
 	static void debug(std::format_string<Args...> const& formatString, Args&&... args) noexcept {
 		IMPL_CHECK_STATES(LogLevel::Debug)
-			log_impl(std::nullopt, states, LogLevel::Debug, formatString, std::forward<Args>(args)...);
+			log_impl(LogLevel::Debug, nullptr, states, formatString.get(), std::make_format_args(args...));
 
 		return;
 	}
@@ -154,7 +160,7 @@ public:
 	template <typename ...Args>
 	static void info(std::format_string<Args...> const& formatString, Args&&... args) noexcept {
 		IMPL_CHECK_STATES(LogLevel::Info)
-			log_impl(std::nullopt, states, LogLevel::Info, formatString, std::forward<Args>(args)...);
+			log_impl(LogLevel::Info, nullptr, states, formatString.get(), std::make_format_args(args...));
 
 		return;
 	}
@@ -167,7 +173,7 @@ public:
 	template <typename ...Args>
 	static void warn(std::format_string<Args...> const& formatString, Args&&... args) noexcept {
 		IMPL_CHECK_STATES(LogLevel::Warn)
-			log_impl(std::nullopt, states, LogLevel::Warn, formatString, std::forward<Args>(args)...);
+			log_impl(LogLevel::Warn, nullptr, states, formatString.get(), std::make_format_args(args...));
 
 		return;
 	}
@@ -180,7 +186,7 @@ public:
 	template <typename ...Args>
 	static void error(std::format_string<Args...> const& formatString, Args&&... args) noexcept {
 		IMPL_CHECK_STATES(LogLevel::Error)
-			log_impl(std::nullopt, states, LogLevel::Error, formatString, std::forward<Args>(args)...);
+			log_impl(LogLevel::Error, nullptr, states, formatString.get(), std::make_format_args(args...));
 
 		return;
 	}
@@ -223,8 +229,63 @@ public:
 		 */
 		ANSITag bodyTag;
 	};
+	/**
+	 * @brief Precomputed header strings of a log level. Opaque outside of Aurora
+	 *
+	 */
+	struct LevelPrefix;
+	/**
+	 * @brief A handle to a registered custom log level (@see aurora::log::registerLogLevel)
+	 *
+	 */
+	class CustomLogLevel final {
+	public:
+		/**
+		 * @brief Gets the log level, which this custom level follows
+		 *
+		 * @return Log level
+		 */
+		[[nodiscard]] LogLevel getLogLevel() const noexcept { return m_logLevel; }
+
+	private:
+		friend class log;
+
+		CustomLogLevel(LogLevel logLevel, LevelPrefix const* prefix) noexcept
+			: m_logLevel(logLevel)
+			, m_prefix(prefix) {}
+
+		// Fields
+		LogLevel m_logLevel;
+		LevelPrefix const* m_prefix;
+	};
+	/**
+	 * @brief Registers a custom log level. Its header is rendered once here instead of on every log
+	 *
+	 * @details The strings of @p config are copied, so they don't have to outlive the call.
+	 * Registered levels are never freed, so this is meant to be called once per level (e.g. on startup)
+	 *
+	 * @param config Config of the logging level (@see aurora::log::CustomLogLevelConfig)
+	 * @return Handle to pass to @ref aurora::log::custom
+	 */
+	static CustomLogLevel registerLogLevel(CustomLogLevelConfig const& config) noexcept;
+	/**
+	 * @brief Logs at the registered custom level
+	 * 
+	 * @param logLevel Registered custom level (@see aurora::log::registerLogLevel)
+	 * @param formatString String to format against (e.g. `"Hello, my name is {}"`)
+	 * @param args Args to format with. Should match the number of fields in @p formatString
+	 */
+	template <typename ...Args>
+	static void custom(CustomLogLevel logLevel, std::format_string<Args...> const& formatString, Args&&... args) noexcept {
+		IMPL_CHECK_STATES(logLevel.m_logLevel)
+			log_impl(logLevel.m_logLevel, logLevel.m_prefix, states, formatString.get(), std::make_format_args(args...));
+
+		return;
+	}
 	/**
 	 * @brief Logs at the custom level
+	 *
+	 * @details The header of the level is rendered on every call; prefer registering the level once with @ref aurora::log::registerLogLevel
 	 * 
 	 * @param config Config of the logging level (@see aurora::log::CustomLogLevelConfig)
 	 * @param formatString String to format against (e.g. `"Hello, my name is {}"`)
@@ -233,50 +294,130 @@ public:
 	template <typename ...Args>
 	static void custom(CustomLogLevelConfig const& config, std::format_string<Args...> const& formatString, Args&&... args) noexcept {
 		IMPL_CHECK_STATES(config.logLevel)
-			log_impl(config, states, LogLevel::Error, formatString, std::forward<Args>(args)...);
+			log_impl(config, states, formatString.get(), std::make_format_args(args...));
 
 		return;
 	}
 
-private:
-	using ConfigOpt = std::optional<std::reference_wrapper<CustomLogLevelConfig const>>;
-	template <typename ...Args>
-	static void log_impl(
-		ConfigOpt const& customConfig,
-		LogStates const& states,
-		LogLevel logLevel,
-		std::format_string<Args...> const& formatString,
-		Args&&... args
-	) noexcept {
-		auto string = logString(
-			customConfig,
-			logLevel,
-			std::format(formatString, std::forward<Args>(args)...)
-		);
-
-		if (states.first)
-			std::print(s_logToStderr ? std::cerr : std::cout, "{}", string);
-		if (states.second) {
-			static auto const& ansiRegex = *(new std::regex(R"(\x1B\[[\d;]*m)"));
-
-			auto fileString = std::regex_replace(string, ansiRegex, "");
-
-			for (auto const& filename : TargetManager::get()->getLogTargets()) {
-				std::ofstream F(filename, std::ios::app);
-				F << fileString;
-				F.close();
-			}
+	/**
+	 * @brief A record, written in parts as it's being built (@see aurora::log::stream)
+	 *
+	 * @details The header is written once, then the body is written to the console and the targets (files) in chunks,
+	 * so large payloads (e.g. @ref aurora::hexdump of a packet) are never materialized as a whole, not even the output of a single call.
+	 * Past the size limit, output is only counted.
+	 * The record ends with @ref aurora::log::RecordBuilder::end or the destruction of the builder.
+	 * Records of other threads may come in between chunks, which end at line breaks where possible;
+	 * logging from the same thread meanwhile is written right away, in between chunks
+	 *
+	 */
+	class RecordBuilder final {
+	public:
+		RecordBuilder(RecordBuilder const&) = delete;
+		RecordBuilder& operator=(RecordBuilder const&) = delete;
+		RecordBuilder(RecordBuilder&&) = delete;
+		RecordBuilder& operator=(RecordBuilder&&) = delete;
+
+		~RecordBuilder() noexcept { this->end(); }
+
+		/**
+		 * @brief Appends a string to the body
+		 *
+		 * @param str String to append
+		 * @return The builder
+		 */
+		RecordBuilder& write(std::string_view str) noexcept;
+		/**
+		 * @brief Appends a formatted string to the body
+		 *
+		 * @param formatString String to format against (e.g. `"{} bytes:\n{}"`)
+		 * @param args Args to format with. Should match the number of fields in @p formatString
+		 * @return The builder
+		 */
+		template <typename ...Args>
+		RecordBuilder& format(std::format_string<Args...> const& formatString, Args&&... args) noexcept {
+			if (m_active)
+				this->vformat(formatString.get(), std::make_format_args(args...));
+
+			return *this;
 		}
+		/**
+		 * @brief Ends the record. Does nothing if the record is already ended
+		 *
+		 */
+		void end() noexcept;
 
-		return;
+		/**
+		 * @brief Gets whether the record is written anywhere. Building an inactive record costs nothing
+		 *
+		 * @return Current value
+		 */
+		[[nodiscard]] bool isActive() const noexcept { return m_active; }
+
+	private:
+		friend class log;
+
+		RecordBuilder(LogLevel logLevel, LevelPrefix const* prefix, std::size_t maxSize) noexcept;
+
+		// an output iterator appending to the chunk (@see aurora::log::RecordBuilder::append)
+		struct ChunkWriter;
+
+		void vformat(std::string_view formatString, std::format_args args) noexcept;
+		// appends to the chunk up to the size limit and writes the chunk whenever it's full; bytes past the limit are only counted
+		void append(std::string_view str) noexcept;
+		void flushChunk(bool last) noexcept;
+
+		// Fields
+		LogLevel m_logLevel;
+		LevelPrefix const* m_prefix;
+		LogStates m_states;
+		bool m_active;
+		bool m_started = false;
+		std::size_t m_maxSize;
+		std::size_t m_size = 0u;
+		std::chrono::system_clock::time_point m_time{};
+		std::string m_chunk{};
+		std::string m_console{};
+		std::string m_plain{};
+		// the whole plain record, if it goes to a shared ring
+		std::string m_ringRecord{};
+		bool m_toRing = false;
+	};
+	/**
+	 * @brief Starts a streamed record (@see aurora::log::RecordBuilder)
+	 *
+	 * @param logLevel Log level of the record
+	 * @param maxSize Maximum size of the body in bytes; the rest is omitted and counted. `0` for no limit
+	 * @return The builder
+	 */
+	[[nodiscard]] static RecordBuilder stream(LogLevel logLevel, std::size_t maxSize = 0u) noexcept {
+		return { logLevel, nullptr, maxSize };
+	}
+	/**
+	 * @brief Starts a streamed record at the registered custom level (@see aurora::log::RecordBuilder)
+	 *
+	 * @param logLevel Registered custom level (@see aurora::log::registerLogLevel)
+	 * @param maxSize Maximum size of the body in bytes; the rest is omitted and counted. `0` for no limit
+	 * @return The builder
+	 */
+	[[nodiscard]] static RecordBuilder stream(CustomLogLevel logLevel, std::size_t maxSize = 0u) noexcept {
+		return { logLevel.m_logLevel, logLevel.m_prefix, maxSize };
 	}
 
-	static std::string logString(
-		ConfigOpt const& customConfig,
+private:
+	// the only non-template part of the logging functions; every argument pack funnels into here type-erased
+	static void log_impl(
 		LogLevel logLevel,
-		std::string&& formattedBody
+		LevelPrefix const* prefix,
+		LogStates const& states,
+		std::string_view formatString,
+		std::format_args args
+	) noexcept;
+	static void log_impl(
+		CustomLogLevelConfig const& config,
+		LogStates const& states,
+		std::string_view formatString,
+		std::format_args args
 	) noexcept;
-	static std::string&& limitStr(std::string&& str) noexcept;
 };
 
 } // namespace aurora
\ No newline at end of file
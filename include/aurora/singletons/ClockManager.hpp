@@ -0,0 +1,193 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+	#define AURORA_HAS_TSC
+
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+	#else
+		#include <x86intrin.h>
+	#endif
+#endif
+
+
+namespace aurora {
+
+/**
+ * @brief Manages the timestamp source of log records.
+ * A singleton
+ *
+ * @details Records are stamped with raw ticks of the selected clock on the hot path;
+ * the ticks are converted to wall-clock time only when the record is formatted
+ *
+ */
+class ClockManager final {
+public:
+	/**
+	 * @brief Instance getting method
+	 *
+	 * @return Instance of a singleton
+	 */
+	static ClockManager* get() noexcept;
+
+	ClockManager(ClockManager const&) = delete;
+	ClockManager& operator=(ClockManager const&) = delete;
+	ClockManager(ClockManager&&) = delete;
+	ClockManager& operator=(ClockManager&&) = delete;
+
+private:
+	ClockManager() noexcept;
+	~ClockManager();
+
+public:
+	/**
+	 * @brief An enum, containing all available clock sources
+	 *
+	 */
+	enum class ClockSource : std::uint8_t {
+		System,
+		Steady,
+		TSC
+	};
+	/**
+	 * @brief Raw timestamp of a record
+	 *
+	 */
+	struct Timestamp final {
+		std::uint64_t ticks;
+		ClockSource source;
+	};
+
+	/**
+	 * @brief Checks whether the CPU timestamp counter is available and invariant
+	 *
+	 * @return Boolean, indicating that `ClockSource::TSC` can be used
+	 */
+	[[nodiscard]] static bool isTSCInvariant() noexcept;
+
+	/**
+	 * @brief Gets the current clock source. `ClockSource::System` by default
+	 *
+	 * @return Current value
+	 */
+	[[nodiscard]] ClockSource getClockSource() const noexcept { return m_source.load(std::memory_order_relaxed); }
+	/**
+	 * @brief Sets the current clock source. `ClockSource::System` by default
+	 *
+	 * @details Selecting `ClockSource::TSC` calibrates the counter against `std::chrono::system_clock`, which takes a few milliseconds.
+	 * If the counter is not invariant, `ClockSource::Steady` is used instead
+	 *
+	 * @param source Value to set
+	 * @return Boolean, indicating that @p source is now in use
+	 */
+	bool setClockSource(ClockSource source) noexcept;
+
+	/**
+	 * @brief Gets the interval at which the TSC/steady clock is re-synchronized with the system clock. `1s` by default
+	 *
+	 * @return Current value
+	 */
+	[[nodiscard]] std::chrono::milliseconds getResyncInterval() const noexcept {
+		return std::chrono::milliseconds(m_resyncIntervalNs.load(std::memory_order_relaxed) / 1'000'000);
+	}
+	/**
+	 * @brief Sets the interval at which the TSC/steady clock is re-synchronized with the system clock. `1s` by default
+	 *
+	 * @param interval Value to set
+	 */
+	void setResyncInterval(std::chrono::milliseconds interval) noexcept {
+		m_resyncIntervalNs.store(
+			static_cast<std::int64_t>(std::chrono::nanoseconds(interval).count()),
+			std::memory_order_relaxed
+		);
+	}
+
+	/**
+	 * @brief Reads the current clock source. Meant for the hot path
+	 *
+	 * @return Raw timestamp
+	 */
+	[[nodiscard]] Timestamp now() const noexcept {
+		namespace ch = std::chrono;
+
+		switch (auto source = m_source.load(std::memory_order_relaxed)) {
+			#if defined(AURORA_HAS_TSC)
+				case ClockSource::TSC:
+					return { __rdtsc(), source };
+			#endif
+
+			case ClockSource::Steady:
+				return {
+					static_cast<std::uint64_t>(ch::duration_cast<ch::nanoseconds>(
+						ch::steady_clock::now().time_since_epoch()
+					).count()),
+					source
+				};
+
+			case ClockSource::System: [[fallthrough]];
+			default:
+				return {
+					static_cast<std::uint64_t>(ch::duration_cast<ch::nanoseconds>(
+						ch::system_clock::now().time_since_epoch()
+					).count()),
+					ClockSource::System
+				};
+		}
+	}
+	/**
+	 * @brief Converts a raw timestamp to wall-clock time. Meant for the formatting side
+	 *
+	 * @details The TSC/steady clock mapping is re-synchronized with the system clock once per resync interval.
+	 * Differences below half the interval are slewed, i.e. corrected gradually over the next interval, so converted times don't jump;
+	 * larger ones (e.g. the system clock was set) are applied as a single step
+	 *
+	 * @param timestamp Raw timestamp
+	 * @return Wall-clock time
+	 */
+	[[nodiscard]] std::chrono::system_clock::time_point toSystemTime(Timestamp timestamp) noexcept;
+
+private:
+	struct Calibration final {
+		std::uint64_t tsc;
+		std::int64_t steadyNs;
+		std::int64_t systemNs;
+		double nsPerTick;
+		// difference to the system clock left at the last resync, corrected over `slewWindowNs` after it
+		std::int64_t slewNs;
+		std::int64_t slewWindowNs;
+	};
+
+	[[nodiscard]] Calibration loadCalibration() const noexcept;
+	void storeCalibration(Calibration const& calibration) noexcept;
+	void calibrate(bool measureTSC) noexcept;
+	void resync(ClockSource source) noexcept;
+	// nanoseconds since the sync point of @p calibration for a raw timestamp of @p source
+	[[nodiscard]] static std::int64_t sinceSync(Calibration const& calibration, ClockSource source, std::uint64_t ticks) noexcept;
+	[[nodiscard]] static std::int64_t mapToSystem(Calibration const& calibration, std::int64_t sinceSync) noexcept;
+
+	// Fields
+	std::atomic<ClockSource> m_source = ClockSource::System;
+	std::atomic_int64_t m_resyncIntervalNs = 1'000'000'000;
+
+	// calibration is published through a seqlock, as it's read for every record
+	std::atomic_uint64_t m_sequence = 0u;
+	std::atomic_uint64_t m_tsc = 0u;
+	std::atomic_int64_t m_steadyNs = 0;
+	std::atomic_int64_t m_systemNs = 0;
+	std::atomic<double> m_nsPerTick = 0.0;
+	std::atomic_int64_t m_slewNs = 0;
+	std::atomic_int64_t m_slewWindowNs = 0;
+
+	// the calibration lock; defined in the source file
+	struct State;
+	std::unique_ptr<State> m_state;
+	std::uint64_t m_originTSC = 0u;
+	std::int64_t m_originSteadyNs = 0;
+};
+
+} // namespace aurora
\ No newline at end of file
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <aurora/log.hpp>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <chrono>
+#include <utility>
+#include <cstdint>
+
+
+namespace aurora {
+
+namespace test { struct Access; }
+
+/**
+ * @brief Tracks logging throughput and sheds low-priority records when it exceeds a budget.
+ * A singleton
+ *
+ * @details Records and bytes per second are measured per sink over one-second windows.
+ * A window is closed by the first record after it ends, or by the background writer while buffered output is enabled (@see aurora::WriterManager).
+ * While a sink is over its budget, its effective logging level is raised step by step (e.g. `Debug` -> `Info` -> `Warn`)
+ * until the load it would take fits the budget; once the load drops, the levels set with @ref aurora::log::setLogLevel,
+ * @ref aurora::log::setFileLogLevel and of the targets (@see aurora::TargetManager::TargetConfig::logLevel) are restored. Errors are never shed. A warning is logged when shedding starts, changes and ends
+ *
+ */
+class LoadManager final {
+public:
+	/**
+	 * @brief Instance getting method
+	 *
+	 * @return Instance of a singleton
+	 */
+	static LoadManager* get() noexcept;
+
+	LoadManager(LoadManager const&) = delete;
+	LoadManager& operator=(LoadManager const&) = delete;
+	LoadManager(LoadManager&&) = delete;
+	LoadManager& operator=(LoadManager&&) = delete;
+
+private:
+	LoadManager() noexcept;
+	~LoadManager();
+
+public:
+	/**
+	 * @brief Length of a measurement window
+	 *
+	 */
+	static constexpr auto kWindow = std::chrono::seconds(1);
+
+	/**
+	 * @brief An enum, containing all sinks with a budget
+	 *
+	 */
+	enum class Sink : std::uint8_t {
+		Console,
+		// all targets (files) together
+		File
+	};
+	/**
+	 * @brief A budget of a sink. `0` disables a limit
+	 *
+	 */
+	struct Budget final {
+		std::uint64_t recordsPerSecond = 0u;
+		std::uint64_t bytesPerSecond = 0u;
+	};
+	/**
+	 * @brief Throughput of a sink over the last window
+	 *
+	 */
+	struct Throughput final {
+		double recordsPerSecond = 0.0;
+		double bytesPerSecond = 0.0;
+	};
+
+	/**
+	 * @brief Gets the budget of a sink. No limits by default
+	 *
+	 * @param sink Sink
+	 * @return Current value
+	 */
+	[[nodiscard]] Budget getBudget(Sink sink) const noexcept;
+	/**
+	 * @brief Sets the budget of a sink. No limits by default
+	 *
+	 * @details Removing all limits of a sink stops its shedding right away
+	 *
+	 * @param sink Sink
+	 * @param budget Value to set
+	 */
+	void setBudget(Sink sink, Budget const& budget) noexcept;
+
+	/**
+	 * @brief Gets the throughput of a sink over the last window. Only measured while any budget is set
+	 *
+	 * @param sink Sink
+	 * @return Current value
+	 */
+	[[nodiscard]] Throughput getThroughput(Sink sink) const noexcept;
+	/**
+	 * @brief Gets the minimum log level a sink currently admits because of shedding; `LogLevel::Debug` if it isn't shedding
+	 *
+	 * @details The effective level of the sink is the higher one of this and its configured level
+	 *
+	 * @param sink Sink
+	 * @return Current value
+	 */
+	[[nodiscard]] log::LogLevel getShedLevel(Sink sink) const noexcept {
+		return m_sinks[std::to_underlying(sink)].shedLevel.load(std::memory_order_relaxed);
+	}
+
+private:
+	friend class log;
+	friend class log::RecordBuilder;
+	friend class WriterManager;
+	friend struct test::Access;
+	[[nodiscard]] bool isEnabled() const noexcept { return m_enabled.load(std::memory_order_relaxed); }
+	// closes the current window if it's over
+	void tick() noexcept;
+	// counts a record that passed the configured levels and decides whether each sink still takes it; @return `{ console, file }`
+	[[nodiscard]] std::pair<bool, bool> admit(log::LogLevel logLevel, bool toConsole, bool toFile) noexcept;
+	void addBytes(std::size_t consoleBytes, std::size_t fileBytes) noexcept;
+	void closeWindow(std::int64_t elapsed) noexcept;
+
+	struct SinkState final {
+		// records per log level that passed the configured level of the sink in the current window
+		std::array<std::atomic_uint64_t, 4u> offered{};
+		std::atomic_uint64_t bytes = 0u;
+		std::atomic<log::LogLevel> shedLevel = log::LogLevel::Debug;
+
+		// guarded by the lock of the state
+		Budget budget{};
+		Throughput throughput{};
+		// bytes per record, kept from the last window that wrote anything
+		double recordSize = 0.0;
+	};
+
+	// the lock of budgets and measurements; defined in the source file
+	struct State;
+
+	// Fields
+	std::unique_ptr<State> m_state;
+	std::atomic_bool m_enabled = false;
+	// start of the current window in steady clock nanoseconds
+	std::atomic_int64_t m_windowStart = 0;
+	std::array<SinkState, 2u> m_sinks{};
+};
+
+} // namespace aurora
\ No newline at end of file
@@ -1,8 +1,18 @@
 #pragma once
 
+#include <aurora/log.hpp>
+#include <aurora/SharedRing.hpp>
+
+#include <flat_map>
 #include <flat_set>
+#include <array>
 #include <string>
+#include <string_view>
 #include <optional>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <chrono>
 #include <cstdint>
 
 
@@ -28,11 +38,156 @@ public:
 	TargetManager& operator=(TargetManager&&) = delete;
 
 private:
-	TargetManager() noexcept = default;
-	~TargetManager() = default;
+	TargetManager() noexcept;
+	~TargetManager();
 
 	[[nodiscard]] bool canOpenFile(std::string_view pathToAFile) const noexcept;
 
+public:
+	/**
+	 * @brief An enum, containing all available target output formats
+	 *
+	 */
+	enum class Format : std::uint8_t {
+		// ANSI tags are stripped
+		Plain,
+		// same as console output
+		ANSI
+	};
+	/**
+	 * @brief A configuration structure of a target (file)
+	 *
+	 */
+	struct TargetConfig final {
+		/**
+		 * @brief Minimum log level of the target
+		 *
+		 * @details Unset, the target follows the file logging level (@see aurora::log::setFileLogLevel).
+		 * Set, it replaces that level for this target, so it may take records below it
+		 *
+		 */
+		std::optional<log::LogLevel> logLevel{};
+		/**
+		 * @brief Output format of the target
+		 *
+		 */
+		Format format = Format::Plain;
+		/**
+		 * @brief Whether the target is written as compressed blocks (@see aurora::LogBlock)
+		 *
+		 * @details Records are collected into blocks (@see aurora::TargetManager::setBlockSize), which are compressed and written by a background thread.
+		 * Compressed targets aren't indexed, as block headers already carry time ranges; read them with the `aurora-unpack` tool
+		 *
+		 */
+		bool compressed = false;
+	};
+
+private:
+	friend class log;
+	friend class log::RecordBuilder;
+	friend class WriterManager;
+	friend class ThreadManager;
+	friend class LoadManager;
+	// bitmask of formats (`1 << Format`) wanted by targets at a log level; 0 if none wants it
+	[[nodiscard]] std::uint8_t formatsFor(log::LogLevel logLevel) noexcept;
+	// lowest log level any target takes; the file logging level if there are no targets
+	[[nodiscard]] log::LogLevel lowestLogLevel() const noexcept;
+	void updateFormats() noexcept;
+	void writeRecord(
+		log::LogLevel logLevel,
+		std::chrono::system_clock::time_point time,
+		std::string_view plain,
+		std::string_view ansi
+	) noexcept;
+	// a record may be written in parts (@see aurora::log::RecordBuilder); @p first and @p last mark its beginning and end
+	void writeToTargets(
+		log::LogLevel logLevel,
+		std::chrono::system_clock::time_point time,
+		std::string_view plain,
+		std::string_view ansi,
+		bool first = true,
+		bool last = true
+	) noexcept;
+	[[nodiscard]] bool writesToRing() const noexcept { return m_ring.load() != nullptr; }
+	// swaps a retired ring (@see aurora::SharedRing::isRetired) for the one that replaced it; nullptr if there is none yet
+	std::shared_ptr<SharedRing> reattachSharedRing(std::shared_ptr<SharedRing> retired) noexcept;
+
+	// a descriptor kept open for the lifetime of a target, so records can be written from signal handlers
+	struct File final {
+		explicit File(int fd) noexcept : fd(fd) {}
+		File(File const&) = delete;
+		File& operator=(File const&) = delete;
+		~File() noexcept;
+
+		int fd;
+	};
+
+	// an open index (@see aurora::LogIndex)
+	struct IndexState;
+	// @p begin and @p end are positions in the file before and after the record was written
+	void indexRecord(
+		std::string const& pathToAFile,
+		log::LogLevel logLevel,
+		std::chrono::system_clock::time_point time,
+		std::uint64_t begin,
+		std::uint64_t end,
+		bool first,
+		bool last
+	) noexcept;
+	void closeIndex(IndexState& state) noexcept;
+	void closeIndexes() noexcept;
+
+	// a block being filled or waiting for compression (@see aurora::LogBlock)
+	struct BlockState;
+	void appendToBlock(
+		std::string const& pathToAFile,
+		log::LogLevel logLevel,
+		std::chrono::system_clock::time_point time,
+		std::string_view record,
+		bool first,
+		bool last
+	) noexcept;
+	void sealBlock(BlockState& state) noexcept;
+	void flushBlocks() noexcept;
+	void compressBlocks(std::stop_token stop) noexcept;
+
+	// per-thread segments (@see aurora::TargetManager::setThreadSegmentsEnabled); these only touch the calling thread's segment
+	[[nodiscard]] bool hasThreadSegment() noexcept;
+	// segments replace the target of the auto-managed directory, so they're only used while nothing else would get the records.
+	// The caller holds the lock
+	[[nodiscard]] bool segmentsUsable() const noexcept;
+	void openThreadSegment(std::uint64_t generation) noexcept;
+	// @return Boolean, indicating that the record went to a segment instead of the targets
+	bool writeToThreadSegment(
+		log::LogLevel logLevel,
+		std::chrono::system_clock::time_point time,
+		std::string_view record
+	) noexcept;
+	// makes every thread reopen its segment on its next record, e.g. after a change of segment settings
+	void renewThreadSegments() noexcept;
+	// makes a single thread reopen its segment on its next record, e.g. after it's renamed
+	void renewThreadSegment(std::thread::id id) noexcept;
+	// gives the calling thread a segment on its next record, once it's named; other threads never get one
+	void registerThreadSegment() noexcept;
+
+	// crash flush (@see aurora::WriterManager::setCrashFlushEnabled). The caller holds the locks; nothing is allocated.
+	// The statics these use are initialized up front, as a first use isn't async-signal-safe
+	void prepareCrashFlush() noexcept;
+	[[nodiscard]] bool tryLockTargetsOnCrash() noexcept;
+	[[nodiscard]] bool tryLockBlocksOnCrash() noexcept;
+	void unlockOnCrash(bool blocksLocked) noexcept;
+	void writeBlocksOnCrash() noexcept;
+	// buffers of thread segments; these have a lock of their own
+	[[nodiscard]] bool tryLockSegmentsOnCrash() noexcept;
+	void unlockSegmentsOnCrash() noexcept;
+	void writeSegmentsOnCrash() noexcept;
+	void writeRecordOnCrash(
+		log::LogLevel logLevel,
+		std::chrono::system_clock::time_point time,
+		std::string_view plain,
+		std::string_view ansi
+	) noexcept;
+
 public:
 	/**
 	 * @brief An `std::flat_set` of all currently active targets (files)
@@ -40,11 +195,22 @@ public:
 	 */
 	using Targets = std::flat_set<std::string>;
 	/**
-	 * @brief Gets the current log targets (files) <em>by `const&`</em>
+	 * @brief An `std::flat_map` of all currently active targets (files) and their configs
+	 *
+	 */
+	using TargetConfigs = std::flat_map<std::string, TargetConfig>;
+	/**
+	 * @brief Gets the current log targets (files)
 	 * 
-	 * @return Currently active targets
+	 * @return A copy of currently active targets
+	 */
+	[[nodiscard]] Targets getLogTargets() const noexcept;
+	/**
+	 * @brief Gets the current log targets (files) with their configs
+	 *
+	 * @return A copy of currently active targets and their configs
 	 */
-	[[nodiscard]] Targets const& getLogTargets() const noexcept { return m_logTargets; }
+	[[nodiscard]] TargetConfigs getLogTargetConfigs() const noexcept;
 	/**
 	 * @brief Adds a new target (file) for logging
 	 * 
@@ -52,6 +218,14 @@ public:
 	 * @return Boolean, indicating successful creation
 	 */
 	bool addLogTarget(std::string_view pathToAFile) noexcept;
+	/**
+	 * @brief Adds a new target (file) for logging with its own log level and format
+	 * 
+	 * @param pathToAFile Absolute/relative to the executable path to a file
+	 * @param config Config of the target (@see aurora::TargetManager::TargetConfig)
+	 * @return Boolean, indicating successful creation
+	 */
+	bool addLogTarget(std::string_view pathToAFile, TargetConfig const& config) noexcept;
 	/**
 	 * @brief Removes a target (file) from current targets
 	 * 
@@ -94,11 +268,163 @@ public:
 	 * @return Path to the current log or `std::nullopt` if the creation failed
 	 */
 	std::optional<std::string> logToDir(std::string_view directory, std::string_view filename) noexcept;
+	/**
+	 * @brief Adds the specified directory as an auto-managed directory for the current session, with its own log level and format
+	 *
+	 * @details Same as @ref aurora::TargetManager::logToDir(std::string_view, std::string_view), including all the cautions
+	 *
+	 * @param directory Directory path to use for log storage
+	 * @param filename Identifier of log files
+	 * @param config Config of the target (@see aurora::TargetManager::TargetConfig)
+	 * @return Path to the current log or `std::nullopt` if the creation failed
+	 */
+	std::optional<std::string> logToDir(
+		std::string_view directory,
+		std::string_view filename,
+		TargetConfig const& config
+	) noexcept;
+
+	/**
+	 * @brief Gets the sidecar index interval as `{ records, kilobytes }`. `{ 0, 0 }` (disabled) by default
+	 *
+	 * @return Current value
+	 */
+	[[nodiscard]] std::pair<std::uint32_t, std::uint32_t> getIndexInterval() const noexcept;
+	/**
+	 * @brief Sets the sidecar index interval. `{ 0, 0 }` (disabled) by default
+	 *
+	 * @details When enabled, every target (file) gets an index (@see aurora::LogIndex) next to it,
+	 * with an entry every @p records records or @p kilobytes KB, whichever comes first. A `0` disables that limit.
+	 * The `aurora-query` tool uses these indexes to extract time windows and level ranges without reading the whole file
+	 *
+	 * @param records Maximum number of records per entry
+	 * @param kilobytes Maximum size of records per entry in KB
+	 */
+	void setIndexInterval(std::uint32_t records, std::uint32_t kilobytes) noexcept;
+
+	/**
+	 * @brief Gets the size of blocks of compressed targets in KB. `64` by default
+	 *
+	 * @return Current value
+	 */
+	[[nodiscard]] std::uint32_t getBlockSize() const noexcept;
+	/**
+	 * @brief Sets the size of blocks of compressed targets in KB. `64` by default
+	 *
+	 * @details Larger blocks compress better, but keep more records in memory until they are written.
+	 * A block is sealed before a record would make it outgrow this size. At most `65536` (64 MB, @see aurora::LogBlock::kMaxRawSize);
+	 * a single record larger than that is split across blocks
+	 *
+	 * @param kilobytes Value to set
+	 */
+	void setBlockSize(std::uint32_t kilobytes) noexcept;
+
+	/**
+	 * @brief Gets per-thread segments setting. `false` by default
+	 *
+	 * @return Current value
+	 */
+	[[nodiscard]] bool getThreadSegmentsEnabled() const noexcept;
+	/**
+	 * @brief Sets per-thread segments setting. `false` by default
+	 *
+	 * @details When enabled, file output of every thread named with @ref aurora::ThreadManager::addThread goes to a segment (@see aurora::LogSegment)
+	 * of its own instead of the targets: `<filename> <date> [<thread name>].seg` next to the log of the last @ref aurora::TargetManager::logToDir call.
+	 * Each thread buffers and writes its segment itself, so records of named threads don't contend on any lock or queue.
+	 * Buffers are written when full, on @ref aurora::TargetManager::flushThreadSegment, when the thread exits
+	 * and by the crash flush (@see aurora::WriterManager::setCrashFlushEnabled).
+	 * Segments take the place of the log of the auto-managed directory and get the levels it takes. They're suspended, and records go to the targets as usual,
+	 * while it isn't the only target, is compressed, targets are indexed (@see aurora::TargetManager::setIndexInterval) or output goes to a shared ring;
+	 * a notice is logged whenever that suspends or resumes them. Threads without a name, and all threads while segments are disabled, skip segments without taking any lock.
+	 * Use @ref aurora::LogSegment::merge or the `aurora-merge` tool to get a single log ordered by time
+	 *
+	 * @param on Value to set
+	 * @return Boolean, indicating success; enabling fails without a @ref aurora::TargetManager::logToDir directory.
+	 * Enabling while segments would be suspended succeeds with a warning
+	 */
+	bool setThreadSegmentsEnabled(bool on) noexcept;
+	/**
+	 * @brief Writes the buffered records of the calling thread's segment, if it has one
+	 *
+	 */
+	void flushThreadSegment() noexcept;
+
+	/**
+	 * @brief Sends file output of this process to a shared memory ring instead of the log targets (files)
+	 *
+	 * @details Meant for multiple processes logging to the same directory: only the collector (@see aurora::TargetManager::collectSharedRing)
+	 * touches the files, so processes don't race on pruning and writes. If the collector closes the ring or replaces it on a restart,
+	 * the process moves over to the new ring once there is one; records in between are dropped. Only available on POSIX systems
+	 *
+	 * @param name Name of the ring, created by the collector (e.g. `/aurora`)
+	 * @return Boolean, indicating successful attachment
+	 */
+	bool logToSharedRing(std::string_view name) noexcept;
+	/**
+	 * @brief Creates a shared memory ring and drains it from a background thread into an auto-managed directory
+	 *
+	 * @details File output of this process is sent to the ring as well, so the directory gets a single ordered log.
+	 * Rings carry plain records, so @ref aurora::TargetManager::Format::ANSI targets receive them without ANSI tags.
+	 * Records dropped by the ring are reported every 10 seconds.
+	 * Same cautions as for @ref aurora::TargetManager::logToDir apply
+	 *
+	 * @param name Name of the ring (e.g. `/aurora`)
+	 * @param directory Directory path to use for log storage
+	 * @param filename Identifier of log files (@see aurora::TargetManager::logToDir)
+	 * @param slotCount Number of records the ring can hold
+	 * @param slotSize Maximum size of a single record in bytes. Longer records are truncated
+	 * @return Path to the current log or `std::nullopt` if the creation failed
+	 */
+	std::optional<std::string> collectSharedRing(
+		std::string_view name,
+		std::string_view directory,
+		std::string_view filename,
+		std::uint32_t slotCount = 8192u,
+		std::uint32_t slotSize = 1024u
+	) noexcept;
+	/**
+	 * @brief Detaches from the shared memory ring and stops collecting it, if this process is the collector
+	 *
+	 */
+	void detachSharedRing() noexcept;
 
 private:
 	// Fields
-	Targets m_logTargets{};
+	TargetConfigs m_logTargets{};
+	std::flat_map<std::string, std::shared_ptr<File>> m_files{};
 	std::uint16_t m_maxFilesInADir = 5;
+	std::array<std::atomic_uint8_t, 4u> m_formats{};
+	// formats of targets following the file logging level, which may change at any time
+	std::atomic_uint8_t m_fileLevelFormats = 0u;
+
+	// locks, open indexes and blocks; defined in the source file
+	struct State;
+	std::unique_ptr<State> m_state;
+
+	std::uint32_t m_indexRecords = 0u;
+	std::uint32_t m_indexKilobytes = 0u;
+
+	std::uint32_t m_blockKilobytes = 64u;
+	bool m_compressing = false;
+	std::jthread m_compressor{};
+
+	// read on every record of a named thread, so segments cost unnamed threads and disabled segments nothing
+	std::atomic_bool m_segments = false;
+	// whether segments are enabled, but currently can't be used (@see aurora::TargetManager::segmentsUsable)
+	std::atomic_bool m_segmentsSuspended = false;
+	// `<directory>/<filename> <date>` of the last auto-managed directory and its log
+	std::string m_segmentsPrefix{};
+	std::string m_segmentsTarget{};
+	// bumped on every change of segment settings; threads compare it against the generation of their segment.
+	// Changes to a single thread renew only its segment (@see aurora::TargetManager::renewThreadSegment)
+	std::atomic_uint64_t m_segmentsGeneration = 1u;
+
+	std::atomic<std::shared_ptr<SharedRing>> m_ring{};
+	// m_ring for the crash flush, as loading an std::atomic<std::shared_ptr> may take a lock
+	std::atomic<SharedRing*> m_crashRing = nullptr;
+	// steady clock nanoseconds of the last reattachment attempt
+	std::atomic_int64_t m_ringReattach = 0;
+	std::jthread m_collector{};
 };
 
 } // namespace aurora
\ No newline at end of file
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <thread>
+#include <memory>
+#include <atomic>
+#include <flat_map>
+#include <string>
+#include <optional>
+#include <chrono>
+#include <cstdint>
+
+
+namespace aurora {
+
+/**
+ * @brief Manages the Chrome trace event target (a JSON file).
+ * A singleton
+ *
+ * @details The written file follows the `trace_event` JSON array format and can be opened
+ * in `chrome://tracing` or Perfetto. Thread names from @ref aurora::ThreadManager are used as track names
+ *
+ */
+class TraceManager final {
+public:
+	/**
+	 * @brief Instance getting method
+	 *
+	 * @return Instance of a singleton
+	 */
+	static TraceManager* get() noexcept;
+
+	TraceManager(TraceManager const&) = delete;
+	TraceManager& operator=(TraceManager const&) = delete;
+	TraceManager(TraceManager&&) = delete;
+	TraceManager& operator=(TraceManager&&) = delete;
+
+private:
+	TraceManager() noexcept;
+	~TraceManager();
+
+public:
+	/**
+	 * @brief Clock used for span timestamps
+	 *
+	 */
+	using Clock = std::chrono::steady_clock;
+
+	/**
+	 * @brief Gets the current trace target (file)
+	 *
+	 * @return Path to the trace file or `std::nullopt` if tracing is disabled
+	 */
+	[[nodiscard]] std::optional<std::string> getTraceTarget() const noexcept;
+	/**
+	 * @brief Sets the trace target (file). The file is truncated
+	 *
+	 * @param pathToAFile Absolute/relative to the executable path to a file
+	 * @return Boolean, indicating successful creation
+	 */
+	bool setTraceTarget(std::string_view pathToAFile) noexcept;
+	/**
+	 * @brief Flushes and closes the current trace target (file)
+	 *
+	 */
+	void clearTraceTarget() noexcept;
+	/**
+	 * @brief Checks whether a trace target (file) is set
+	 *
+	 * @return Boolean, indicating that spans will be recorded
+	 */
+	[[nodiscard]] bool isTracing() const noexcept { return m_tracing.load(std::memory_order_relaxed); }
+
+	/**
+	 * @brief Records a complete span on the @em calling @em thread's track
+	 *
+	 * @param name Name of the span
+	 * @param begin Timestamp of the span start
+	 * @param end Timestamp of the span end
+	 */
+	void addSpan(std::string_view name, Clock::time_point begin, Clock::time_point end) noexcept;
+
+private:
+	void flush() noexcept;
+	std::uint32_t trackFor(std::thread::id id) noexcept;
+
+	// the trace file and its lock; defined in the source file
+	struct State;
+
+	// Fields
+	std::unique_ptr<State> m_state;
+	std::atomic_bool m_tracing = false;
+	std::string m_path{};
+	std::string m_buffer{};
+	Clock::time_point m_epoch{};
+	std::flat_map<std::thread::id, std::pair<std::uint32_t, std::string>> m_tracks{};
+};
+
+} // namespace aurora
\ No newline at end of file
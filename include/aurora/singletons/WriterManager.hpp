@@ -0,0 +1,216 @@
+#pragma once
+
+#include <aurora/log.hpp>
+
+#include <array>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <cstdint>
+
+
+namespace aurora {
+
+/**
+ * @brief Manages buffered (asynchronous) output of rendered records.
+ * A singleton
+ *
+ * @details When enabled, records are rendered on the logging thread and written by a background writer.
+ * Error records travel on a separate lane, which is never dropped and is written ahead of other records.
+ * What happens to other records when the writer falls behind is controlled per level (@see aurora::WriterManager::BackpressurePolicy)
+ *
+ */
+class WriterManager final {
+public:
+	/**
+	 * @brief Instance getting method
+	 *
+	 * @return Instance of a singleton
+	 */
+	static WriterManager* get() noexcept;
+
+	WriterManager(WriterManager const&) = delete;
+	WriterManager& operator=(WriterManager const&) = delete;
+	WriterManager(WriterManager&&) = delete;
+	WriterManager& operator=(WriterManager&&) = delete;
+
+private:
+	WriterManager() noexcept;
+	~WriterManager();
+
+public:
+	/**
+	 * @brief An enum, containing all available backpressure policies
+	 *
+	 */
+	enum class BackpressurePolicy : std::uint8_t {
+		// the logging thread waits for the writer
+		Block,
+		// the record being logged is dropped
+		DropNewest,
+		// the oldest queued record of a level with this policy is dropped to make room; without one, the record being logged is dropped
+		DropOldest,
+		// the record is written to the overflow file by the logging thread
+		Spill
+	};
+
+	/**
+	 * @brief A rendered record
+	 *
+	 */
+	struct Record final {
+		log::LogLevel logLevel;
+		std::chrono::system_clock::time_point time;
+		std::string console;
+		std::string file;
+		bool toConsole;
+		bool toFile;
+	};
+
+	/**
+	 * @brief Gets buffered output setting. `false` by default
+	 *
+	 * @return Current value
+	 */
+	[[nodiscard]] bool getAsyncEnabled() const noexcept { return m_async.load(std::memory_order_relaxed); }
+	/**
+	 * @brief Sets buffered output setting. `false` by default
+	 *
+	 * @details Disabling it flushes all queued records and stops the writer
+	 *
+	 * @param on Value to set
+	 */
+	void setAsyncEnabled(bool on) noexcept;
+
+	/**
+	 * @brief Gets the maximum number of queued non-error records. `8192` by default
+	 *
+	 * @return Current value
+	 */
+	[[nodiscard]] std::size_t getQueueCapacity() const noexcept;
+	/**
+	 * @brief Sets the maximum number of queued non-error records. `8192` by default
+	 *
+	 * @param capacity Value to set
+	 */
+	void setQueueCapacity(std::size_t capacity) noexcept;
+
+	/**
+	 * @brief Gets the backpressure policy of a log level. `BackpressurePolicy::Block` by default
+	 *
+	 * @param logLevel Log level
+	 * @return Current value
+	 */
+	[[nodiscard]] BackpressurePolicy getBackpressurePolicy(log::LogLevel logLevel) const noexcept;
+	/**
+	 * @brief Sets the backpressure policy of a log level. `BackpressurePolicy::Block` by default
+	 *
+	 * @details Has no effect on `LogLevel::Error`, as error records are never dropped
+	 *
+	 * @param logLevel Log level
+	 * @param policy Value to set
+	 */
+	void setBackpressurePolicy(log::LogLevel logLevel, BackpressurePolicy policy) noexcept;
+
+	/**
+	 * @brief Sets the overflow file for `BackpressurePolicy::Spill`
+	 *
+	 * @details Without an overflow file, spilled records are dropped
+	 *
+	 * @param pathToAFile Absolute/relative to the executable path to a file
+	 * @return Boolean, indicating successful creation
+	 */
+	bool setOverflowFile(std::string_view pathToAFile) noexcept;
+
+	/**
+	 * @brief Gets the number of records of a log level dropped because the writer fell behind
+	 *
+	 * @param logLevel Log level
+	 * @return Current value
+	 */
+	[[nodiscard]] std::uint64_t getDroppedCount(log::LogLevel logLevel) const noexcept {
+		return m_dropped[std::to_underlying(logLevel)].load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Waits until all queued records are written, then writes the buffered records of the overflow file
+	 *
+	 */
+	void flush() noexcept;
+
+	/**
+	 * @brief Gets crash flush setting. `false` by default
+	 *
+	 * @return Current value
+	 */
+	[[nodiscard]] bool getCrashFlushEnabled() const noexcept { return m_crashFlush.load(std::memory_order_relaxed); }
+	/**
+	 * @brief Sets crash flush setting. `false` by default
+	 *
+	 * @details When enabled, handlers for `SIGSEGV`, `SIGABRT`, `SIGBUS`, `SIGFPE`, `SIGTERM` and `std::terminate` write pending records
+	 * (queued records, unwritten blocks of compressed targets and buffered records of the overflow file and of thread segments)
+	 * with `write(2)` on the descriptors of the targets,
+	 * then pass the signal on to the previous handler, which usually terminates the process. Ignored signals stay ignored.
+	 * Console output still in stdio buffers is written on a best-effort basis on glibc only, as those buffers can't be locked from a handler.
+	 * Records may be written twice if the process survives the signal. Only available on POSIX systems
+	 *
+	 * @param on Value to set
+	 * @return Boolean, indicating success
+	 */
+	bool setCrashFlushEnabled(bool on) noexcept;
+
+private:
+	friend class log;
+	friend class log::RecordBuilder;
+	void submit(Record&& record) noexcept;
+
+	void emit(Record const& record) noexcept;
+	void spill(Record const& record) noexcept;
+	void drop(log::LogLevel logLevel) noexcept;
+	void reportDrops() noexcept;
+	void run(std::stop_token stop) noexcept;
+
+	// streamed records (@see aurora::log::RecordBuilder) are written synchronously, and take the output only to write a chunk
+	void beginStream() noexcept;
+	void endStream() noexcept;
+	void lockOutput() noexcept;
+	void unlockOutput() noexcept;
+
+	void flushOnCrash() noexcept;
+	static void onFatalSignal(int signal) noexcept;
+	static void onTerminate() noexcept;
+
+	// Fields
+	std::atomic_bool m_async = false;
+	std::jthread m_writer{};
+
+	// locks, condition variables and the overflow file; defined in the source file
+	struct State;
+	std::unique_ptr<State> m_state;
+
+	// guarded by the queue lock of the state
+	std::deque<Record> m_errorLane{};
+	std::deque<Record> m_lane{};
+	std::atomic_bool m_hasErrors = false;
+	std::size_t m_capacity = 8192u;
+	bool m_running = false;
+	bool m_writing = false;
+	std::array<BackpressurePolicy, 3u> m_policies{};
+	// the batch being written by the writer and its progress
+	std::vector<Record> m_errors{};
+	std::vector<Record> m_records{};
+	std::atomic_size_t m_errorsDone = 0u;
+	std::atomic_size_t m_recordsDone = 0u;
+
+	std::array<std::atomic_uint64_t, 4u> m_dropped{};
+	std::uint64_t m_reportedDrops = 0u;
+
+
+	std::atomic_bool m_crashFlush = false;
+};
+
+} // namespace aurora
\ No newline at end of file
@@ -2,4 +2,8 @@
 
 
 #include "ThreadManager.hpp" // IWYU pragma: keep
-#include "TargetManager.hpp" // IWYU pragma: keep
\ No newline at end of file
+#include "TargetManager.hpp" // IWYU pragma: keep
+#include "TraceManager.hpp" // IWYU pragma: keep
+#include "ClockManager.hpp" // IWYU pragma: keep
+#include "WriterManager.hpp" // IWYU pragma: keep
+#include "LoadManager.hpp" // IWYU pragma: keep
\ No newline at end of file
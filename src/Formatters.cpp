@@ -0,0 +1,94 @@
+#include <aurora/Formatters.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+using namespace aurora;
+
+
+namespace {
+
+constexpr char kHexDigits[] = "0123456789abcdef";
+
+} // namespace
+
+
+// lines are rendered into a small buffer, so the dump is never materialized as a whole
+std::format_context::iterator std::formatter<HexDump>::format(HexDump const& hexDump, std::format_context& ctx) const {
+	auto out = ctx.out();
+	auto data = hexDump.data;
+
+	for (std::size_t offset = 0u; offset < data.size(); offset += 16u) {
+		// `00000000  xx xx xx xx xx xx xx xx  xx xx xx xx xx xx xx xx  |................|`
+		std::array<char, 80u> line;
+		line.fill(' ');
+		auto lineSize = data.size() - offset < 16u ? data.size() - offset : 16u;
+
+		for (std::size_t i = 0u; i < 8u; ++i)
+			line[i] = kHexDigits[(offset >> (28u - i * 4u)) & 0xFu];
+
+		for (std::size_t i = 0u; i < lineSize; ++i) {
+			auto byte = static_cast<std::uint8_t>(data[offset + i]);
+			auto column = 10u + i * 3u + (i >= 8u ? 1u : 0u);
+
+			line[column] = kHexDigits[byte >> 4u];
+			line[column + 1u] = kHexDigits[byte & 0xFu];
+			line[61u + i] = byte >= 0x20u && byte < 0x7Fu ? static_cast<char>(byte) : '.';
+		}
+		line[60u] = '|';
+		line[61u + lineSize] = '|';
+
+		auto size = 62u + lineSize;
+		if (offset != 0u)
+			*out++ = '\n';
+		out = std::copy_n(line.data(), size, out);
+	}
+
+	return out;
+}
+
+std::format_context::iterator std::formatter<Truncated>::format(Truncated const& truncated, std::format_context& ctx) const {
+	if (truncated.data.size() <= truncated.maxSize)
+		return std::ranges::copy(truncated.data, ctx.out()).out;
+
+	auto out = std::ranges::copy(truncated.data.substr(0u, truncated.maxSize), ctx.out()).out;
+
+	return std::format_to(out, "... [+{} bytes]", truncated.data.size() - truncated.maxSize);
+}
+
+std::format_context::iterator std::formatter<Escaped>::format(Escaped const& escaped, std::format_context& ctx) const {
+	auto out = ctx.out();
+
+	for (auto c : escaped.data) {
+		auto byte = static_cast<std::uint8_t>(c);
+
+		switch (c) {
+			case '\\':
+				out = std::ranges::copy(std::string_view("\\\\"), out).out;
+				break;
+
+			case '\n':
+				out = std::ranges::copy(std::string_view("\\n"), out).out;
+				break;
+
+			case '\r':
+				out = std::ranges::copy(std::string_view("\\r"), out).out;
+				break;
+
+			case '\t':
+				out = std::ranges::copy(std::string_view("\\t"), out).out;
+				break;
+
+			default:
+				if (byte >= 0x20u && byte < 0x7Fu) {
+					*out++ = c;
+				} else {
+					char hex[] = { '\\', 'x', kHexDigits[byte >> 4u], kHexDigits[byte & 0xFu] };
+					out = std::copy_n(hex, 4u, out);
+				}
+		}
+	}
+
+	return out;
+}
\ No newline at end of file
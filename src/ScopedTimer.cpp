@@ -0,0 +1,41 @@
+#include <aurora/ScopedTimer.hpp>
+
+#include <chrono>
+
+using namespace aurora;
+
+
+void ScopedTimer::stop() noexcept {
+	if (m_stopped)
+		return;
+
+	m_end = TraceManager::Clock::now();
+	m_stopped = true;
+
+	if (m_output != Output::Log)
+		TraceManager::get()->addSpan(m_name, m_begin, m_end);
+
+	if (m_output != Output::Trace) {
+		auto ms = std::chrono::duration<double, std::milli>(m_end - m_begin).count();
+
+		switch (m_logLevel) {
+			case log::LogLevel::Debug:
+				log::debug("[{}] took {:.2f} ms", m_name, ms);
+				break;
+
+			case log::LogLevel::Info:
+				log::info("[{}] took {:.2f} ms", m_name, ms);
+				break;
+
+			case log::LogLevel::Warn:
+				log::warn("[{}] took {:.2f} ms", m_name, ms);
+				break;
+
+			case log::LogLevel::Error: [[fallthrough]];
+			default:
+				log::error("[{}] took {:.2f} ms", m_name, ms);
+		}
+	}
+
+	return;
+}
\ No newline at end of file
@@ -0,0 +1,410 @@
+#include <aurora/SharedRing.hpp>
+
+#include <atomic>
+#include <algorithm>
+#include <bit>
+#include <new>
+#include <cstring>
+
+#if !defined(_WIN32)
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <pthread.h>
+	#include <signal.h>
+	#include <cerrno>
+#endif
+
+using namespace aurora;
+
+
+struct SharedRing::Header final {
+	std::atomic_uint64_t magic;
+	std::uint32_t slotCount;
+	std::uint32_t slotSize;
+	std::uint32_t slotStride;
+	// process of the collector, so a ring is only taken over once its collector is gone
+	std::atomic_int32_t owner;
+
+	// producers of different processes hammer these, so they get their own cache lines
+	alignas(64) std::atomic_uint64_t head;
+	alignas(64) std::atomic_uint64_t dropped;
+	// only written by the collector, so a collector taking over the ring knows where to continue
+	alignas(64) std::atomic_uint64_t tail;
+};
+
+struct SharedRing::Slot final {
+	// `position` when free, `position + 1` when it holds a record of that position
+	std::atomic_uint64_t sequence;
+	// Unix time in nanoseconds
+	std::int64_t time;
+	std::uint32_t size;
+	std::int32_t pid;
+	log::LogLevel logLevel;
+
+	// the record itself follows the slot header
+	[[nodiscard]] char* data() noexcept { return reinterpret_cast<char*>(this + 1); }
+};
+
+
+namespace {
+
+static_assert(std::atomic_uint64_t::is_always_lock_free, "Shared memory ring requires lock-free 64-bit atomics");
+
+// bumped together with any layout change of the header or the slots
+constexpr std::uint64_t kMagic = 0x41555252'494E4704; // "AURRING" v4
+// stored over the magic of a closed or replaced ring; the magic comes first in every version of the layout
+constexpr std::uint64_t kRetired = 0u;
+
+constexpr std::size_t kHeaderSize = 256u;
+
+constexpr auto kStallTimeout = std::chrono::milliseconds(500);
+
+std::string shmName(std::string_view name) noexcept {
+	if (name.starts_with('/'))
+		return std::string(name);
+
+	return std::string("/").append(name);
+}
+
+#if !defined(_WIN32)
+	// getpid() is a system call, so the pid is cached and refreshed in forked children
+	std::atomic_int32_t s_pid = 0;
+
+	std::int32_t currentPid() noexcept {
+		[[maybe_unused]] static bool const registered = []() {
+			s_pid.store(getpid(), std::memory_order_relaxed);
+			pthread_atfork(nullptr, nullptr, []() { s_pid.store(getpid(), std::memory_order_relaxed); });
+
+			return true;
+		}();
+
+		return s_pid.load(std::memory_order_relaxed);
+	}
+
+	// a pid reused by another process counts as alive; leaving a dead collector's ring alone beats stealing a live one's
+	bool isAlive(std::int32_t pid) noexcept {
+		return pid > 0 && (kill(pid, 0) == 0 || errno == EPERM);
+	}
+
+	// works on rings of any version, as long as they can be mapped
+	void retire(std::string const& path) noexcept {
+		int fd = shm_open(path.c_str(), O_RDWR, 0);
+		if (fd == -1)
+			return;
+
+		struct stat st;
+		if (fstat(fd, &st) == 0 && static_cast<std::size_t>(st.st_size) >= sizeof(std::uint64_t)) {
+			auto memory = mmap(nullptr, sizeof(std::uint64_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+			if (memory != MAP_FAILED) {
+				static_cast<std::atomic_uint64_t*>(memory)->store(kRetired, std::memory_order_release);
+				munmap(memory, sizeof(std::uint64_t));
+			}
+		}
+		close(fd);
+
+		return;
+	}
+#endif
+
+} // namespace
+
+
+std::unique_ptr<SharedRing> SharedRing::create(
+	std::string_view name,
+	std::uint32_t slotCount,
+	std::uint32_t slotSize
+) noexcept {
+	#if defined(_WIN32)
+		log::warn("[AURORA] Shared memory rings are not supported on this platform.");
+		return nullptr;
+	#else
+		static_assert(sizeof(Header) <= kHeaderSize);
+
+		auto path = shmName(name);
+		slotCount = std::bit_ceil(std::max(slotCount, 2u));
+		slotSize = std::max(slotSize, 64u);
+		auto slotStride = static_cast<std::uint32_t>((sizeof(Slot) + slotSize + 63u) & ~std::size_t(63u));
+		auto size = kHeaderSize + std::size_t(slotStride) * slotCount;
+
+		if (auto ring = attach(path, true)) {
+			auto& header = ring->header();
+
+			if (header.slotCount == slotCount && header.slotSize == slotSize) {
+				auto owner = header.owner.load(std::memory_order_relaxed);
+				if (owner != currentPid() && (isAlive(owner) || !header.owner.compare_exchange_strong(owner, currentPid()))) {
+					log::warn("[AURORA] Failed to create shared ring '{}': collected by process {}.", ring->m_name, owner);
+					return nullptr;
+				}
+
+				ring->m_owner = true;
+				ring->m_tail = header.tail.load(std::memory_order_relaxed);
+
+				log::info(
+					"[AURORA] Took over shared ring '{}' with {} pending record(s).",
+					ring->m_name, header.head.load(std::memory_order_relaxed) - ring->m_tail
+				);
+				return ring;
+			}
+		}
+
+		// producers of the old ring reopen the new one
+		retire(path);
+		shm_unlink(path.c_str());
+
+		int fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+		if (fd == -1) {
+			log::warn("[AURORA] Failed to create shared ring '{}': {}.", path, std::strerror(errno));
+			return nullptr;
+		}
+
+		if (ftruncate(fd, static_cast<off_t>(size)) == -1) {
+			log::warn("[AURORA] Failed to size shared ring '{}': {}.", path, std::strerror(errno));
+			close(fd);
+			shm_unlink(path.c_str());
+			return nullptr;
+		}
+
+		auto memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if (memory == MAP_FAILED) {
+			log::warn("[AURORA] Failed to map shared ring '{}': {}.", path, std::strerror(errno));
+			close(fd);
+			shm_unlink(path.c_str());
+			return nullptr;
+		}
+
+		auto header = new (memory) Header();
+		header->slotCount = slotCount;
+		header->slotSize = slotSize;
+		header->slotStride = slotStride;
+		header->owner.store(currentPid(), std::memory_order_relaxed);
+		header->head.store(0u, std::memory_order_relaxed);
+		header->dropped.store(0u, std::memory_order_relaxed);
+		header->tail.store(0u, std::memory_order_relaxed);
+
+		auto ring = std::unique_ptr<SharedRing>(new SharedRing(std::move(path), fd, memory, size, true));
+		for (std::uint64_t i = 0u; i < slotCount; ++i)
+			(new (&ring->slot(i)) Slot())->sequence.store(i, std::memory_order_relaxed);
+
+		// producers only attach once the magic is visible
+		header->magic.store(kMagic, std::memory_order_release);
+
+		return ring;
+	#endif
+}
+
+std::unique_ptr<SharedRing> SharedRing::open(std::string_view name) noexcept {
+	#if defined(_WIN32)
+		log::warn("[AURORA] Shared memory rings are not supported on this platform.");
+		return nullptr;
+	#else
+		return attach(shmName(name), false);
+	#endif
+}
+
+std::unique_ptr<SharedRing> SharedRing::reopen() const noexcept {
+	#if defined(_WIN32)
+		return nullptr;
+	#else
+		return attach(m_name, true);
+	#endif
+}
+
+std::unique_ptr<SharedRing> SharedRing::attach(std::string path, [[maybe_unused]] bool quiet) noexcept {
+	#if defined(_WIN32)
+		return nullptr;
+	#else
+		int fd = shm_open(path.c_str(), O_RDWR, 0);
+		if (fd == -1) {
+			if (!quiet)
+				log::warn("[AURORA] Failed to open shared ring '{}': {}.", path, std::strerror(errno));
+			return nullptr;
+		}
+
+		struct stat st;
+		if (fstat(fd, &st) == -1 || static_cast<std::size_t>(st.st_size) < kHeaderSize) {
+			if (!quiet)
+				log::warn("[AURORA] Failed to open shared ring '{}': invalid size.", path);
+			close(fd);
+			return nullptr;
+		}
+
+		auto size = static_cast<std::size_t>(st.st_size);
+		auto memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if (memory == MAP_FAILED) {
+			if (!quiet)
+				log::warn("[AURORA] Failed to map shared ring '{}': {}.", path, std::strerror(errno));
+			close(fd);
+			return nullptr;
+		}
+
+		auto header = static_cast<Header*>(memory);
+		if (
+			header->magic.load(std::memory_order_acquire) != kMagic
+			|| kHeaderSize + std::size_t(header->slotStride) * header->slotCount != size
+		) {
+			if (!quiet)
+				log::warn("[AURORA] Failed to open shared ring '{}': incompatible layout.", path);
+			munmap(memory, size);
+			close(fd);
+			return nullptr;
+		}
+
+		return std::unique_ptr<SharedRing>(new SharedRing(std::move(path), fd, memory, size, false));
+	#endif
+}
+
+SharedRing::SharedRing(std::string name, int fd, void* memory, std::size_t size, bool owner) noexcept
+	: m_name(std::move(name))
+	, m_fd(fd)
+	, m_memory(memory)
+	, m_size(size)
+	, m_owner(owner) {
+	#if !defined(_WIN32)
+		// the pid is cached before any push, so pushing stays async-signal-safe (@see aurora::WriterManager::setCrashFlushEnabled)
+		currentPid();
+	#endif
+}
+
+SharedRing::~SharedRing() noexcept {
+	#if !defined(_WIN32)
+		// producers still attached move over to the next ring of this name; a retired ring's name already belongs to that one
+		bool unlink = m_owner && !this->isRetired();
+		if (unlink)
+			this->header().magic.store(kRetired, std::memory_order_release);
+
+		munmap(m_memory, m_size);
+		close(m_fd);
+
+		if (unlink)
+			shm_unlink(m_name.c_str());
+	#endif
+}
+
+
+bool SharedRing::push(
+	log::LogLevel logLevel,
+	std::chrono::system_clock::time_point time,
+	std::string_view record
+) noexcept {
+	namespace ch = std::chrono;
+
+	if (this->isRetired())
+		return false;
+
+	std::uint64_t pos;
+	auto slot = this->reserve(pos);
+	if (!slot)
+		return false;
+
+	auto slotSize = this->header().slotSize;
+	if (record.size() > slotSize) {
+		// keep the record newline-terminated
+		record = record.substr(0u, slotSize);
+		std::memcpy(slot->data(), record.data(), record.size() - 1u);
+		slot->data()[record.size() - 1u] = '\n';
+	} else {
+		std::memcpy(slot->data(), record.data(), record.size());
+	}
+	slot->time = ch::duration_cast<ch::nanoseconds>(time.time_since_epoch()).count();
+	slot->size = static_cast<std::uint32_t>(record.size());
+	#if !defined(_WIN32)
+		slot->pid = currentPid();
+	#endif
+	slot->logLevel = logLevel;
+
+	// fails if the collector already skipped the slot (@see aurora::SharedRing::pop)
+	auto expected = pos;
+	return slot->sequence.compare_exchange_strong(expected, pos + 1u, std::memory_order_release, std::memory_order_relaxed);
+}
+
+SharedRing::Slot* SharedRing::reserve(std::uint64_t& position) noexcept {
+	auto& head = this->header().head;
+	position = head.load(std::memory_order_relaxed);
+
+	while (true) {
+		auto& slot = this->slot(position);
+
+		auto sequence = slot.sequence.load(std::memory_order_acquire);
+		auto diff = static_cast<std::int64_t>(sequence - position);
+
+		if (diff == 0) {
+			if (head.compare_exchange_weak(position, position + 1u, std::memory_order_relaxed))
+				return &slot;
+		} else if (diff < 0) {
+			// the collector hasn't freed this slot yet; the ring is full
+			this->header().dropped.fetch_add(1u, std::memory_order_relaxed);
+			return nullptr;
+		} else {
+			position = head.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+std::optional<SharedRing::Entry> SharedRing::pop(std::string& record) noexcept {
+	namespace ch = std::chrono;
+
+	auto& header = this->header();
+
+	while (true) {
+		auto& slot = this->slot(m_tail);
+
+		if (slot.sequence.load(std::memory_order_acquire) == m_tail + 1u) {
+			record.assign(slot.data(), slot.size);
+			Entry entry{
+				slot.logLevel,
+				ch::system_clock::time_point(ch::duration_cast<ch::system_clock::duration>(ch::nanoseconds(slot.time))),
+				slot.pid
+			};
+
+			slot.sequence.store(m_tail + header.slotCount, std::memory_order_release);
+			header.tail.store(++m_tail, std::memory_order_relaxed);
+			m_stalledSince.reset();
+
+			return entry;
+		}
+
+		// the ring is empty
+		if (header.head.load(std::memory_order_relaxed) == m_tail) {
+			m_stalledSince.reset();
+			return std::nullopt;
+		}
+
+		// the slot is reserved, but its record isn't there yet; a producer that died in between would stall the ring for good
+		auto now = ch::steady_clock::now();
+		if (!m_stalledSince)
+			m_stalledSince = now;
+		if (now - *m_stalledSince < kStallTimeout)
+			return std::nullopt;
+
+		auto expected = m_tail;
+		if (slot.sequence.compare_exchange_strong(expected, m_tail + header.slotCount, std::memory_order_acq_rel)) {
+			header.dropped.fetch_add(1u, std::memory_order_relaxed);
+			header.tail.store(++m_tail, std::memory_order_relaxed);
+			m_stalledSince.reset();
+		}
+	}
+}
+
+
+std::uint64_t SharedRing::getDroppedCount() const noexcept {
+	return this->header().dropped.load(std::memory_order_relaxed);
+}
+
+bool SharedRing::isRetired() const noexcept {
+	return this->header().magic.load(std::memory_order_acquire) != kMagic;
+}
+
+SharedRing::Header& SharedRing::header() const noexcept {
+	return *static_cast<Header*>(m_memory);
+}
+
+SharedRing::Slot& SharedRing::slot(std::uint64_t position) const noexcept {
+	auto& header = this->header();
+	auto index = position & (header.slotCount - 1u);
+
+	return *reinterpret_cast<Slot*>(
+		static_cast<char*>(m_memory) + kHeaderSize + std::size_t(header.slotStride) * index
+	);
+}
\ No newline at end of file
@@ -1,195 +1,503 @@
 #include <aurora/log.hpp>
 
 #include <aurora/singletons/ThreadManager.hpp>
-
+#include <aurora/singletons/TargetManager.hpp>
+#include <aurora/singletons/WriterManager.hpp>
+#include <aurora/singletons/ClockManager.hpp>
+#include <aurora/singletons/LoadManager.hpp>
+
+#include <array>
+#include <deque>
+#include <mutex>
+#include <thread>
 #include <chrono>
+#include <ctime>
+#include <iterator>
+#include <iostream>
+#include <algorithm>
+#include <utility>
 
 using namespace aurora;
 
 
-log::LogStates log::statesForLevel(LogLevel logLevel) noexcept {
-	LogStates ret{};
-
-	switch (logLevel) {
-		case LogLevel::Debug:
-			if (s_logLevel == LogLevel::Debug)
-				ret.first = true;
-			if (s_fileLogLevel == LogLevel::Debug)
-				ret.second = true;
-			break;
+struct log::LevelPrefix final {
+	LogLevel logLevel;
+	std::string_view headTag;
+	// head tag, level name and the separator
+	std::string_view level;
+	// level name and the separator without ANSI tags
+	std::string_view levelPlain;
+	std::string_view bodyTag;
+};
 
-		case LogLevel::Info:
-			if (s_logLevel == LogLevel::Debug || s_logLevel == LogLevel::Info)
-				ret.first = true;
-			if (s_fileLogLevel == LogLevel::Debug || s_fileLogLevel == LogLevel::Info)
-				ret.second = true;
-			break;
 
-		case LogLevel::Warn:
-			if (s_logLevel != LogLevel::Error)
-				ret.first = true;
-			if (s_fileLogLevel != LogLevel::Error)
-				ret.second = true;
+namespace {
+
+#define IMPL_LEVEL_PREFIX(_logLevel, _headTag, _name, _bodyTag) \
+	log::LevelPrefix{ (_logLevel), _headTag, _headTag _name "\e[0m\e[90m |", _name " |", _bodyTag }
+
+constexpr std::array<log::LevelPrefix, 4u> kBuiltinPrefixes{
+	IMPL_LEVEL_PREFIX(log::LogLevel::Debug, "\e[30m", "DEBUG", ""),
+	IMPL_LEVEL_PREFIX(log::LogLevel::Info, "\e[34m", "INFO ", ""),
+	IMPL_LEVEL_PREFIX(log::LogLevel::Warn, "\e[33m", "WARN ", "\e[93m"),
+	IMPL_LEVEL_PREFIX(log::LogLevel::Error, "\e[91m", "ERROR", "\e[31m")
+};
+
+#undef IMPL_LEVEL_PREFIX
+
+constexpr log::LevelPrefix const& builtinPrefix(log::LogLevel logLevel) noexcept {
+	return kBuiltinPrefixes[std::to_underlying(logLevel)];
+}
+
+// renders a custom level into a single buffer; the returned prefix points into @p storage
+log::LevelPrefix makePrefix(log::CustomLogLevelConfig const& config, std::string& storage) noexcept {
+	auto resolve = [](
+		log::CustomLogLevelConfig::ANSITag const& ansiTag,
+		std::string_view log::LevelPrefix::* tag
+	) -> std::string_view {
+		if (std::holds_alternative<log::LogLevel>(ansiTag))
+			return builtinPrefix(std::get<log::LogLevel>(ansiTag)).*tag;
+
+		return std::get<std::string_view>(ansiTag);
+	};
+
+	auto headTag = resolve(config.headTag, &log::LevelPrefix::headTag);
+	auto bodyTag = resolve(config.bodyTag, &log::LevelPrefix::bodyTag);
+	auto name = config.logLevelName;
+	constexpr std::string_view separator = "\e[0m\e[90m |";
+
+	storage.clear();
+	storage.append(headTag).append(name).append(separator)
+		.append(name).append(" |")
+		.append(bodyTag);
+
+	std::string_view view(storage);
+	auto levelSize = headTag.size() + name.size() + separator.size();
+	auto levelPlainSize = name.size() + 2u;
+
+	return {
+		config.logLevel,
+		view.substr(0u, headTag.size()),
+		view.substr(0u, levelSize),
+		view.substr(levelSize, levelPlainSize),
+		view.substr(levelSize + levelPlainSize)
+	};
+}
+
+struct CustomLevel final {
+	std::string storage;
+	log::LevelPrefix prefix;
+};
+
+// a deque never relocates its elements, so handles can point into it
+std::deque<CustomLevel>& customLevels() noexcept {
+	static auto& ret = *(new std::deque<CustomLevel>());
+
+	return ret;
+}
+
+std::mutex& customLevelsMutex() noexcept {
+	static auto& ret = *(new std::mutex());
+
+	return ret;
+}
+
+
+void appendLimited(std::string& out, std::string_view str) noexcept {
+	if (auto maxSourceLength = log::getMaxSourceLength(); str.size() > maxSourceLength)
+		out.append(str.substr(0u, maxSourceLength)).append(">");
+	else
+		out.append(str);
+
+	return;
+}
+
+// strips SGR sequences (`\x1B[...m`) for file output
+void appendStripped(std::string& out, std::string_view str) noexcept {
+	while (!str.empty()) {
+		auto esc = str.find("\x1B[");
+		if (esc == std::string_view::npos)
 			break;
 
-		case LogLevel::Error: [[fallthrough]];
-		default:
-			ret = { true, true };
+		auto end = esc + 2u;
+		while (end < str.size() && (str[end] == ';' || (str[end] >= '0' && str[end] <= '9')))
+			++end;
+
+		if (end < str.size() && str[end] == 'm') {
+			out.append(str.substr(0u, esc));
+			str.remove_prefix(end + 1u);
+		} else {
+			out.append(str.substr(0u, end));
+			str.remove_prefix(end);
+		}
 	}
 
+	out.append(str);
+
+	return;
+}
+
+struct SplitBody final {
+	std::string_view source;
+	std::string_view text;
+	bool hasSource;
+};
+
+// `[Source] text` -> { `Source`, `text` }; the source has to be on the first line
+SplitBody splitSource(std::string_view body) noexcept {
+	if (body.starts_with('[')) {
+		if (
+			auto end = body.find("] ");
+			end != std::string_view::npos && end < body.find('\n')
+		)
+			return { body.substr(1u, end - 1u), body.substr(end + 2u), true };
+	}
+
+	return { {}, body, false };
+}
+
+std::string_view formatTime(std::chrono::system_clock::time_point time, std::array<char, 32u>& buffer) noexcept {
+	auto tt = std::chrono::system_clock::to_time_t(time);
+
+	std::tm localTime;
+
+	#if defined(_MSC_VER)
+		localtime_s(&localTime, &tt);
+	#else
+		localtime_r(&tt, &localTime);
+	#endif
+
+	auto size = std::strftime(
+		buffer.data(), buffer.size(),
+		log::get12hTimeEnabled() ? "%r" : "%H:%M:%OS",
+		&localTime
+	);
+
+	return { buffer.data(), size };
+}
+
+std::string currentThreadName() noexcept {
+	std::string ret;
+	auto thID = std::this_thread::get_id();
+
+	if (auto name = ThreadManager::get()->getThreadNameByID(thID))
+		ret = *name;
+	else
+		appendLimited(ret, std::format("Thread {}", thID));
+
 	return ret;
 }
 
-std::string log::logString(
-	ConfigOpt const& customConfig,
-	log::LogLevel logLevel,
-	std::string&& formattedBody
+// everything up to the body
+void appendConsoleHeader(
+	std::string& out,
+	log::LevelPrefix const& prefix,
+	std::string_view time,
+	std::string_view threadName,
+	SplitBody const& split
 ) noexcept {
-	constexpr auto hasLogLevel = [](CustomLogLevelConfig::ANSITag const& ansiTag) noexcept {
-		return std::holds_alternative<LogLevel>(ansiTag);
-	};
-	constexpr auto getLogLevel = [](CustomLogLevelConfig::ANSITag const& ansiTag) noexcept {
-		return std::get<LogLevel>(ansiTag);
-	};
-	constexpr auto getANSIString = [](CustomLogLevelConfig::ANSITag const& ansiTag) noexcept {
-		return std::get<std::string_view>(ansiTag);
-	};
+	out.append(prefix.headTag).append(time)
+		.append("\e[0m\e[90m | \e[1;30m[").append(threadName).append("\e[0m\e[1;30m]\e[0m ")
+		.append(prefix.level);
+	if (split.hasSource) {
+		out.append(" \e[36m[");
+		appendLimited(out, split.source);
+		out.append("\e[0m\e[36m]\e[90m |");
+	}
+	out.append(" \e[0m").append(prefix.bodyTag);
+
+	return;
+}
+
+void appendFileHeader(
+	std::string& out,
+	log::LevelPrefix const& prefix,
+	std::string_view time,
+	std::string_view threadName,
+	SplitBody const& split
+) noexcept {
+	out.append(time).append(" | [");
+	appendStripped(out, threadName);
+	out.append("] ").append(prefix.levelPlain);
+	if (split.hasSource) {
+		out.append(" [");
+		std::string limitedSource;
+		appendLimited(limitedSource, split.source);
+		appendStripped(out, limitedSource);
+		out.append("] |");
+	}
+	out.append(" ");
+
+	return;
+}
+
+constexpr std::string_view kConsoleTail = "\e[0m\n";
+
+constexpr auto kPlain = 1u << std::to_underlying(TargetManager::Format::Plain);
+constexpr auto kANSI = 1u << std::to_underlying(TargetManager::Format::ANSI);
+
+// streamed records are written in chunks of about this size
+constexpr std::size_t kChunkSize = 16u * 1024u;
+
+} // namespace
+
+
+log::LogStates log::statesForLevel(LogLevel logLevel) noexcept {
+	// this is the only per-record check; targets' levels and formats are folded into a single mask up front
+	bool toConsole = logLevel >= s_logLevel;
+	// targets may take records below the file logging level, so it's applied per target
+	auto formats = TargetManager::get()->formatsFor(logLevel);
+
+	// over budget, sinks take fewer levels than configured (@see aurora::LoadManager)
+	if (auto load = LoadManager::get(); load->isEnabled() && (toConsole || formats)) {
+		auto [console, file] = load->admit(logLevel, toConsole, formats != 0u);
+		toConsole = console;
+		if (!file)
+			formats = 0u;
+	}
+
+	return { toConsole, formats };
+}
+
+log::CustomLogLevel log::registerLogLevel(CustomLogLevelConfig const& config) noexcept {
+	std::lock_guard lock(customLevelsMutex());
+
+	auto& customLevel = customLevels().emplace_back();
+	customLevel.prefix = makePrefix(config, customLevel.storage);
+
+	return { config.logLevel, &customLevel.prefix };
+}
+
+void log::log_impl(
+	CustomLogLevelConfig const& config,
+	LogStates const& states,
+	std::string_view formatString,
+	std::format_args args
+) noexcept {
+	std::string storage;
+	auto prefix = makePrefix(config, storage);
+
+	log_impl(config.logLevel, &prefix, states, formatString, args);
+
+	return;
+}
+
+void log::log_impl(
+	LogLevel logLevel,
+	LevelPrefix const* prefix,
+	LogStates const& states,
+	std::string_view formatString,
+	std::format_args args
+) noexcept {
+	auto timestamp = ClockManager::get()->now();
+
+	if (!prefix)
+		prefix = &builtinPrefix(logLevel);
+
+	std::string formattedBody;
+	std::vformat_to(std::back_inserter(formattedBody), formatString, args);
+
+	std::array<char, 32u> timeBuffer;
+	auto systemTime = ClockManager::get()->toSystemTime(timestamp);
+	auto time = formatTime(systemTime, timeBuffer);
 
-	auto hTag = [&logLevel, &customConfig, &hasLogLevel, &getLogLevel, &getANSIString]() -> std::string_view {
-		if (!customConfig || hasLogLevel(customConfig->get().headTag)) {
-			if (customConfig && hasLogLevel(customConfig->get().headTag))
-				logLevel = getLogLevel(customConfig->get().headTag);
+	auto threadName = currentThreadName();
+	auto split = splitSource(formattedBody);
 
-			switch (logLevel) {
-				case LogLevel::Debug:
-					return "\e[30m";
+	// every format is rendered once, no matter how many targets use it
+	WriterManager::Record record{ logLevel, systemTime, {}, {}, states.first, states.second != 0u };
 
-				case LogLevel::Info:
-					return "\e[34m";
+	if (states.first || (states.second & kANSI)) {
+		auto& string = record.console;
+		string.reserve(128u + formattedBody.size());
 
-				case LogLevel::Warn:
-					return "\e[33m";
+		appendConsoleHeader(string, *prefix, time, threadName, split);
+		string.append(split.text).append(kConsoleTail);
+	}
+	if (states.second & kPlain) {
+		auto& fileString = record.file;
+		fileString.reserve(64u + formattedBody.size());
+
+		appendFileHeader(fileString, *prefix, time, threadName, split);
+		appendStripped(fileString, split.text);
+		fileString.append("\n");
+	}
+
+	if (auto load = LoadManager::get(); load->isEnabled()) {
+		load->addBytes(
+			record.toConsole ? record.console.size() : 0u,
+			!record.toFile ? 0u : (states.second & kPlain) ? record.file.size() : record.console.size()
+		);
+	}
+
+	// a thread with a segment of its own writes it right here, bypassing the queue and the targets' lock
+	if (record.toFile && TargetManager::get()->writeToThreadSegment(logLevel, systemTime, record.file))
+		record.toFile = false;
+
+	if (record.toConsole || record.toFile)
+		WriterManager::get()->submit(std::move(record));
+
+	return;
+}
 
-				case LogLevel::Error:
-					return "\e[91m";
 
-				default:
-					return "\e[0m";
-			}
+log::RecordBuilder::RecordBuilder(LogLevel logLevel, LevelPrefix const* prefix, std::size_t maxSize) noexcept
+	: m_logLevel(logLevel)
+	, m_prefix(prefix ? prefix : &builtinPrefix(logLevel))
+	, m_states(statesForLevel(logLevel))
+	, m_active(m_states.first || m_states.second)
+	, m_maxSize(maxSize) {
+	if (!m_active)
+		return;
+
+	m_time = ClockManager::get()->toSystemTime(ClockManager::get()->now());
+	m_toRing = m_states.second != 0u && TargetManager::get()->writesToRing();
+
+	WriterManager::get()->beginStream();
+}
+
+// formatted output goes straight into the chunk, so no more than a chunk of it is ever buffered
+struct log::RecordBuilder::ChunkWriter final {
+	using difference_type = std::ptrdiff_t;
+
+	ChunkWriter& operator=(char c) noexcept {
+		auto& b = *builder;
+
+		if (b.m_maxSize == 0u || b.m_size < b.m_maxSize) {
+			b.m_chunk.push_back(c);
+			if (b.m_chunk.size() >= kChunkSize)
+				b.flushChunk(false);
 		}
+		++b.m_size;
 
-		// control gets here if a config is present and it's set to a custom tag
-		return getANSIString(customConfig->get().headTag);
-	}();
-
-	// check for a source
-	bool source = false;
-	static auto const& sourceRegex = *(new std::regex(R"(^\[(.*?)\] (.*))"));
-	std::smatch matches;
-
-	if (std::regex_search(formattedBody, matches, sourceRegex))
-		source = true;
-
-	return std::format(
-		"{}" // h tag
-		"{}" // time
-		"\e[0m\e[90m |" // separator
-		" \e[1;30m[{}\e[0m\e[1;30m]\e[0m" // thread
-		" {}" // h tag
-		"{}" // log level
-		"\e[0m\e[90m |" // separator
-		"{}" // optional source specifier
-		" \e[0m{}" // b tag
-		"{}" // body
-		"\e[0m\n", // newline
-
-		hTag, // h tag
-		[]() { // time
-			namespace ch = std::chrono;
-
-			auto tt = ch::system_clock::to_time_t(ch::system_clock::now());
-
-			std::tm localTime;
-
-			#if defined(_MSC_VER)
-				localtime_s(&localTime, &tt);
-			#else
-				localtime_r(&tt, &localTime);
-			#endif
-
-			std::stringstream stream;
-			stream << (s_use12hTime ?
-						std::put_time(&localTime, "%r")
-						:
-						std::put_time(&localTime, "%H:%M:%OS"));
-			
-			return stream.str();
-		}(),
-		[]() { // thread
-			auto thID = std::this_thread::get_id();
-
-			return std::string(ThreadManager::get()->getThreadNameByID(thID).value_or(
-				limitStr(std::format("Thread {}", thID)))
-			);
-		}(),
-		hTag, // h tag
-		[logLevel, &customConfig]() -> std::string_view { // log level
-			if (customConfig)
-				return customConfig->get().logLevelName;
-
-			switch (logLevel) {
-				case LogLevel::Debug:
-					return "DEBUG";
-
-				case LogLevel::Info:
-					return "INFO ";
-
-				case LogLevel::Warn:
-					return "WARN ";
-
-				case LogLevel::Error:
-					return "ERROR";
-
-				default:
-					return "_____";
-			}
-		}(),
-		source ? // optional source specifier
-			std::format(" \e[36m[{}\e[0m\e[36m]\e[90m |", limitStr(matches[1].str()))
-			:
-			"",
-		[&logLevel, &customConfig, &hasLogLevel, &getLogLevel, &getANSIString]() -> std::string_view { // b tag
-			if (!customConfig || hasLogLevel(customConfig->get().bodyTag)) {
-				if (customConfig && hasLogLevel(customConfig->get().bodyTag))
-					logLevel = getLogLevel(customConfig->get().bodyTag);
-
-				switch (logLevel) {
-					case LogLevel::Warn:
-						return "\e[93m";
-
-					case LogLevel::Error:
-						return "\e[31m";
-
-					case LogLevel::Debug: [[fallthrough]];
-					case LogLevel::Info: [[fallthrough]];
-					default:
-						return "";
-				}
-			}
-
-			// control gets here if a config is present and it's set to a custom tag
-			return getANSIString(customConfig->get().bodyTag);
-		}(),
-		source ? // body
-			matches[2].str()
-			:
-			formattedBody
-	);
+		return *this;
+	}
+	ChunkWriter& operator*() noexcept { return *this; }
+	ChunkWriter& operator++() noexcept { return *this; }
+	ChunkWriter operator++(int) noexcept { return *this; }
+
+	RecordBuilder* builder;
+};
+
+log::RecordBuilder& log::RecordBuilder::write(std::string_view str) noexcept {
+	if (m_active)
+		this->append(str);
+
+	return *this;
 }
 
-std::string&& log::limitStr(std::string&& str) noexcept {
-	if (str.size() > s_maxSourceLength)
-		str = str.substr(0, s_maxSourceLength).append(">");
+void log::RecordBuilder::vformat(std::string_view formatString, std::format_args args) noexcept {
+	std::vformat_to(ChunkWriter{ this }, formatString, args);
+
+	return;
+}
+
+void log::RecordBuilder::append(std::string_view str) noexcept {
+	// omitted bytes are still counted
+	auto room = m_maxSize == 0u ? str.size() : m_maxSize - std::min(m_size, m_maxSize);
+	m_size += str.size();
+	str = str.substr(0u, room);
+
+	// a written chunk leaves less than a chunk behind, so this always makes progress
+	while (!str.empty()) {
+		auto part = std::min(str.size(), kChunkSize - m_chunk.size());
+		m_chunk.append(str.substr(0u, part));
+		str.remove_prefix(part);
+
+		if (m_chunk.size() >= kChunkSize)
+			this->flushChunk(false);
+	}
+
+	return;
+}
+
+void log::RecordBuilder::flushChunk(bool last) noexcept {
+	bool first = !m_started;
+	bool toConsole = m_states.first || (m_states.second & kANSI);
+	bool toPlain = m_states.second & kPlain;
+	std::string_view body = m_chunk;
+
+	// records of other threads may come in between chunks, so a chunk ends at a line break where possible
+	if (!last) {
+		if (auto lineEnd = body.rfind('\n'); lineEnd != std::string_view::npos)
+			body = body.substr(0u, lineEnd + 1u);
+	}
+	auto length = body.size();
+
+	// the header is rendered with the first chunk, which has the source specifier
+	if (first) {
+		m_started = true;
+
+		std::array<char, 32u> timeBuffer;
+		auto time = formatTime(m_time, timeBuffer);
+		auto threadName = currentThreadName();
+		auto split = splitSource(body);
+		body = split.text;
+
+		if (toConsole)
+			appendConsoleHeader(m_console, *m_prefix, time, threadName, split);
+		if (toPlain)
+			appendFileHeader(m_plain, *m_prefix, time, threadName, split);
+	}
+
+	if (toConsole)
+		m_console.append(body);
+	if (toPlain)
+		appendStripped(m_plain, body);
+
+	if (last) {
+		std::string omitted;
+		if (m_maxSize != 0u && m_size > m_maxSize)
+			omitted = std::format("... [+{} bytes]", m_size - m_maxSize);
+
+		if (toConsole)
+			m_console.append(omitted).append(kConsoleTail);
+		if (toPlain)
+			m_plain.append(omitted).append("\n");
+	}
+
+	// only writing takes the output, the chunk is rendered without it
+	WriterManager::get()->lockOutput();
+
+	if (m_states.first)
+		(getLogToStderrEnabled() ? std::cerr : std::cout).write(m_console.data(), m_console.size());
+
+	if (auto load = LoadManager::get(); load->isEnabled()) {
+		load->addBytes(
+			m_states.first ? m_console.size() : 0u,
+			!m_states.second ? 0u : toPlain ? m_plain.size() : m_console.size()
+		);
+	}
+
+	// segments take the record chunk by chunk, as consecutive frames with the same time
+	if (m_states.second && !TargetManager::get()->writeToThreadSegment(m_logLevel, m_time, m_plain)) {
+		// ring slots hold whole records
+		if (m_toRing) {
+			m_ringRecord.append(m_plain);
+			if (last)
+				TargetManager::get()->writeRecord(m_logLevel, m_time, m_ringRecord, m_ringRecord);
+		} else {
+			TargetManager::get()->writeToTargets(m_logLevel, m_time, m_plain, m_console, first, last);
+		}
+	}
+
+	WriterManager::get()->unlockOutput();
+
+	m_chunk.erase(0u, length);
+	m_console.clear();
+	m_plain.clear();
+
+	return;
+}
+
+void log::RecordBuilder::end() noexcept {
+	if (!m_active)
+		return;
+
+	this->flushChunk(true);
+	m_active = false;
+
+	WriterManager::get()->endStream();
 
-	return str;
+	return;
 }
\ No newline at end of file
@@ -0,0 +1,256 @@
+#include <aurora/singletons/ClockManager.hpp>
+
+#include <aurora/log.hpp>
+
+#include <algorithm>
+#include <mutex>
+
+#if defined(AURORA_HAS_TSC) && !defined(_MSC_VER)
+	#include <cpuid.h>
+#endif
+
+using namespace aurora;
+
+
+namespace {
+
+std::int64_t steadyNs() noexcept {
+	namespace ch = std::chrono;
+
+	return ch::duration_cast<ch::nanoseconds>(ch::steady_clock::now().time_since_epoch()).count();
+}
+
+std::int64_t systemNs() noexcept {
+	namespace ch = std::chrono;
+
+	return ch::duration_cast<ch::nanoseconds>(ch::system_clock::now().time_since_epoch()).count();
+}
+
+std::uint64_t readTSC() noexcept {
+	#if defined(AURORA_HAS_TSC)
+		return __rdtsc();
+	#else
+		return 0u;
+	#endif
+}
+
+} // namespace
+
+
+struct ClockManager::State final {
+	std::mutex calibrationMutex{};
+};
+
+
+ClockManager* ClockManager::get() noexcept {
+	static auto instance = new ClockManager();
+
+	return instance;
+}
+
+ClockManager::ClockManager() noexcept
+	: m_state(std::make_unique<State>()) {
+	this->calibrate(false);
+}
+
+ClockManager::~ClockManager() = default;
+
+
+bool ClockManager::isTSCInvariant() noexcept {
+	#if defined(AURORA_HAS_TSC)
+		static bool const invariant = []() {
+			// CPUID.80000007H:EDX[8] - invariant TSC
+			unsigned regs[4]{};
+
+			#if defined(_MSC_VER)
+				int info[4]{};
+				__cpuid(info, 0x80000000);
+				if (static_cast<unsigned>(info[0]) < 0x80000007u)
+					return false;
+				__cpuid(info, 0x80000007);
+				regs[3] = static_cast<unsigned>(info[3]);
+			#else
+				if (__get_cpuid_max(0x80000000u, nullptr) < 0x80000007u)
+					return false;
+				__get_cpuid(0x80000007u, &regs[0], &regs[1], &regs[2], &regs[3]);
+			#endif
+
+			return (regs[3] & (1u << 8)) != 0u;
+		}();
+
+		return invariant;
+	#else
+		return false;
+	#endif
+}
+
+bool ClockManager::setClockSource(ClockSource source) noexcept {
+	if (source == ClockSource::TSC) {
+		if (!isTSCInvariant()) {
+			log::warn("[AURORA] TSC is not invariant on this CPU; falling back to the steady clock.");
+			m_source.store(ClockSource::Steady, std::memory_order_relaxed);
+			return false;
+		}
+
+		this->calibrate(true);
+	}
+
+	m_source.store(source, std::memory_order_relaxed);
+
+	return true;
+}
+
+
+std::chrono::system_clock::time_point ClockManager::toSystemTime(Timestamp timestamp) noexcept {
+	namespace ch = std::chrono;
+
+	std::int64_t ns;
+
+	switch (timestamp.source) {
+		case ClockSource::TSC: [[fallthrough]];
+		case ClockSource::Steady: {
+			auto calibration = this->loadCalibration();
+			auto since = sinceSync(calibration, timestamp.source, timestamp.ticks);
+
+			if (since > m_resyncIntervalNs.load(std::memory_order_relaxed))
+				this->resync(timestamp.source);
+
+			ns = mapToSystem(calibration, since);
+			break;
+		}
+
+		case ClockSource::System: [[fallthrough]];
+		default:
+			ns = static_cast<std::int64_t>(timestamp.ticks);
+	}
+
+	return ch::system_clock::time_point(
+		ch::duration_cast<ch::system_clock::duration>(ch::nanoseconds(ns))
+	);
+}
+
+std::int64_t ClockManager::sinceSync(Calibration const& calibration, ClockSource source, std::uint64_t ticks) noexcept {
+	if (source == ClockSource::TSC) {
+		auto elapsed = static_cast<double>(static_cast<std::int64_t>(ticks - calibration.tsc));
+		return static_cast<std::int64_t>(elapsed * calibration.nsPerTick);
+	}
+
+	return static_cast<std::int64_t>(ticks) - calibration.steadyNs;
+}
+
+std::int64_t ClockManager::mapToSystem(Calibration const& calibration, std::int64_t sinceSync) noexcept {
+	auto ret = calibration.systemNs + sinceSync;
+
+	// the correction grows linearly over the window; timestamps taken before the sync point get none
+	if (calibration.slewNs != 0 && calibration.slewWindowNs > 0) {
+		auto progress = std::clamp<std::int64_t>(sinceSync, 0, calibration.slewWindowNs);
+		ret += static_cast<std::int64_t>(
+			static_cast<double>(calibration.slewNs) * static_cast<double>(progress) / static_cast<double>(calibration.slewWindowNs)
+		);
+	}
+
+	return ret;
+}
+
+
+ClockManager::Calibration ClockManager::loadCalibration() const noexcept {
+	Calibration ret;
+
+	while (true) {
+		auto before = m_sequence.load(std::memory_order_acquire);
+		if (before & 1u)
+			continue;
+
+		ret = {
+			m_tsc.load(std::memory_order_relaxed),
+			m_steadyNs.load(std::memory_order_relaxed),
+			m_systemNs.load(std::memory_order_relaxed),
+			m_nsPerTick.load(std::memory_order_relaxed),
+			m_slewNs.load(std::memory_order_relaxed),
+			m_slewWindowNs.load(std::memory_order_relaxed)
+		};
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (m_sequence.load(std::memory_order_relaxed) == before)
+			break;
+	}
+
+	return ret;
+}
+
+void ClockManager::storeCalibration(Calibration const& calibration) noexcept {
+	m_sequence.fetch_add(1u, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	m_tsc.store(calibration.tsc, std::memory_order_relaxed);
+	m_steadyNs.store(calibration.steadyNs, std::memory_order_relaxed);
+	m_systemNs.store(calibration.systemNs, std::memory_order_relaxed);
+	m_nsPerTick.store(calibration.nsPerTick, std::memory_order_relaxed);
+	m_slewNs.store(calibration.slewNs, std::memory_order_relaxed);
+	m_slewWindowNs.store(calibration.slewWindowNs, std::memory_order_relaxed);
+
+	m_sequence.fetch_add(1u, std::memory_order_release);
+
+	return;
+}
+
+void ClockManager::calibrate(bool measureTSC) noexcept {
+	std::lock_guard lock(m_state->calibrationMutex);
+
+	Calibration calibration{ readTSC(), steadyNs(), systemNs(), this->loadCalibration().nsPerTick, 0, 0 };
+	m_originTSC = calibration.tsc;
+	m_originSteadyNs = calibration.steadyNs;
+
+	if (measureTSC) {
+		// spin for a short while to get an initial tick rate; resyncs refine it over a longer baseline
+		constexpr std::int64_t kCalibrationNs = 10'000'000;
+
+		std::int64_t steadyEnd;
+		do
+			steadyEnd = steadyNs();
+		while (steadyEnd - calibration.steadyNs < kCalibrationNs);
+
+		auto tscEnd = readTSC();
+		calibration.nsPerTick = static_cast<double>(steadyEnd - calibration.steadyNs)
+			/ static_cast<double>(tscEnd - calibration.tsc);
+	}
+
+	this->storeCalibration(calibration);
+
+	return;
+}
+
+void ClockManager::resync(ClockSource source) noexcept {
+	std::unique_lock lock(m_state->calibrationMutex, std::try_to_lock);
+	if (!lock.owns_lock())
+		return;
+
+	auto previous = this->loadCalibration();
+	Calibration calibration{ readTSC(), steadyNs(), systemNs(), previous.nsPerTick, 0, 0 };
+
+	// what the previous mapping makes of this instant
+	auto mapped = mapToSystem(
+		previous,
+		sinceSync(previous, source, source == ClockSource::TSC
+			? calibration.tsc
+			: static_cast<std::uint64_t>(calibration.steadyNs))
+	);
+
+	if (calibration.tsc != m_originTSC) {
+		calibration.nsPerTick = static_cast<double>(calibration.steadyNs - m_originSteadyNs)
+			/ static_cast<double>(calibration.tsc - m_originTSC);
+	}
+
+	// the mapping continues from where it was and drifts towards the system clock over the next interval
+	auto interval = m_resyncIntervalNs.load(std::memory_order_relaxed);
+	auto difference = calibration.systemNs - mapped;
+	if (difference > -interval / 2 && difference < interval / 2) {
+		calibration.systemNs = mapped;
+		calibration.slewNs = difference;
+		calibration.slewWindowNs = interval;
+	}
+
+	this->storeCalibration(calibration);
+
+	return;
+}
\ No newline at end of file
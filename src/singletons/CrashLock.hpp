@@ -0,0 +1,47 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <thread>
+
+
+namespace aurora {
+
+/**
+ * @brief A mutex the crash flush can take from a signal handler (@see aurora::WriterManager::setCrashFlushEnabled)
+ *
+ * @details Its holder also sets a flag, which the crash flush takes with an atomic exchange instead of `try_lock`,
+ * as mutexes aren't async-signal-safe. A holder waits for a crash flush that took the flag first.
+ * Internal to Aurora; wait on it with `std::condition_variable_any`
+ *
+ */
+class CrashLock final {
+public:
+	void lock() noexcept {
+		m_mutex.lock();
+		while (m_busy.exchange(true, std::memory_order_acquire))
+			std::this_thread::yield();
+
+		return;
+	}
+	void unlock() noexcept {
+		m_busy.store(false, std::memory_order_release);
+		m_mutex.unlock();
+
+		return;
+	}
+
+	// async-signal-safe
+	[[nodiscard]] bool tryLockOnCrash() noexcept { return !m_busy.exchange(true, std::memory_order_acquire); }
+	void unlockOnCrash() noexcept {
+		m_busy.store(false, std::memory_order_release);
+
+		return;
+	}
+
+private:
+	std::mutex m_mutex{};
+	std::atomic_bool m_busy = false;
+};
+
+} // namespace aurora
\ No newline at end of file
@@ -0,0 +1,217 @@
+#include <aurora/singletons/LoadManager.hpp>
+
+#include <aurora/singletons/TargetManager.hpp>
+
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+#include <string_view>
+
+using namespace aurora;
+
+
+namespace {
+
+constexpr std::int64_t kWindowNs = std::chrono::nanoseconds(LoadManager::kWindow).count();
+// a shed level is only lowered once the load at the lower level fits this share of the budget, so it doesn't flap around the budget
+constexpr double kRestoreRatio = 0.75;
+
+constexpr std::string_view kSinkNames[] = { "Console", "File" };
+constexpr std::string_view kLevelNames[] = { "debug", "info", "warn", "error" };
+
+std::int64_t steadyNow() noexcept {
+	namespace ch = std::chrono;
+
+	return ch::duration_cast<ch::nanoseconds>(ch::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+
+struct LoadManager::State final {
+	std::mutex mutex{};
+};
+
+
+LoadManager* LoadManager::get() noexcept {
+	static auto instance = new LoadManager();
+
+	return instance;
+}
+
+LoadManager::LoadManager() noexcept
+	: m_state(std::make_unique<State>()) {}
+
+LoadManager::~LoadManager() = default;
+
+
+LoadManager::Budget LoadManager::getBudget(Sink sink) const noexcept {
+	std::lock_guard lock(m_state->mutex);
+
+	return m_sinks[std::to_underlying(sink)].budget;
+}
+
+void LoadManager::setBudget(Sink sink, Budget const& budget) noexcept {
+	bool ended;
+	{
+		std::lock_guard lock(m_state->mutex);
+
+		auto& state = m_sinks[std::to_underlying(sink)];
+		state.budget = budget;
+
+		bool limited = budget.recordsPerSecond != 0u || budget.bytesPerSecond != 0u;
+		ended = !limited && state.shedLevel.exchange(log::LogLevel::Debug, std::memory_order_relaxed) != log::LogLevel::Debug;
+
+		bool enabled = false;
+		for (auto const& sinkState : m_sinks)
+			enabled |= sinkState.budget.recordsPerSecond != 0u || sinkState.budget.bytesPerSecond != 0u;
+
+		// measuring starts with a fresh window
+		if (enabled && !m_enabled.load(std::memory_order_relaxed)) {
+			for (auto& sinkState : m_sinks) {
+				for (auto& offered : sinkState.offered)
+					offered.store(0u, std::memory_order_relaxed);
+				sinkState.bytes.store(0u, std::memory_order_relaxed);
+			}
+			m_windowStart.store(steadyNow(), std::memory_order_relaxed);
+		}
+		m_enabled.store(enabled, std::memory_order_relaxed);
+	}
+
+	if (ended)
+		log::warn("[AURORA] {} output budget removed; shedding ended.", kSinkNames[std::to_underlying(sink)]);
+
+	return;
+}
+
+LoadManager::Throughput LoadManager::getThroughput(Sink sink) const noexcept {
+	std::lock_guard lock(m_state->mutex);
+
+	return m_sinks[std::to_underlying(sink)].throughput;
+}
+
+
+void LoadManager::tick() noexcept {
+	auto now = steadyNow();
+	auto start = m_windowStart.load(std::memory_order_relaxed);
+
+	// whoever sees the window end first closes it
+	if (now - start >= kWindowNs && m_windowStart.compare_exchange_strong(start, now, std::memory_order_relaxed))
+		this->closeWindow(now - start);
+
+	return;
+}
+
+std::pair<bool, bool> LoadManager::admit(log::LogLevel logLevel, bool toConsole, bool toFile) noexcept {
+	this->tick();
+
+	auto take = [logLevel](SinkState& state, bool passed) {
+		if (!passed)
+			return false;
+
+		state.offered[std::to_underlying(logLevel)].fetch_add(1u, std::memory_order_relaxed);
+
+		return logLevel >= state.shedLevel.load(std::memory_order_relaxed);
+	};
+
+	return {
+		take(m_sinks[std::to_underlying(Sink::Console)], toConsole),
+		take(m_sinks[std::to_underlying(Sink::File)], toFile)
+	};
+}
+
+void LoadManager::addBytes(std::size_t consoleBytes, std::size_t fileBytes) noexcept {
+	if (consoleBytes != 0u)
+		m_sinks[std::to_underlying(Sink::Console)].bytes.fetch_add(consoleBytes, std::memory_order_relaxed);
+	if (fileBytes != 0u)
+		m_sinks[std::to_underlying(Sink::File)].bytes.fetch_add(fileBytes, std::memory_order_relaxed);
+
+	return;
+}
+
+void LoadManager::closeWindow(std::int64_t elapsed) noexcept {
+	std::array<std::pair<log::LogLevel, log::LogLevel>, 2u> changes;
+	std::array<Throughput, 2u> throughputs;
+	// targets with a level of their own may take more than the file logging level
+	std::array configured{ log::getLogLevel(), TargetManager::get()->lowestLogLevel() };
+	// a window closed late (e.g. by the first record after a quiet period) still stands for a single window, so a burst at its end isn't averaged away
+	double seconds = static_cast<double>(std::min(elapsed, kWindowNs)) / 1e9;
+
+	{
+		std::lock_guard lock(m_state->mutex);
+
+		for (std::size_t i = 0u; i < m_sinks.size(); ++i) {
+			auto& state = m_sinks[i];
+
+			std::array<std::uint64_t, 4u> offered;
+			for (std::size_t level = 0u; level < offered.size(); ++level)
+				offered[level] = state.offered[level].exchange(0u, std::memory_order_relaxed);
+			auto bytes = state.bytes.exchange(0u, std::memory_order_relaxed);
+			auto shed = state.shedLevel.load(std::memory_order_relaxed);
+
+			// records per second the sink would take at a minimum level
+			auto loadAt = [&offered, seconds](std::size_t minLevel) {
+				std::uint64_t ret = 0u;
+				for (auto level = minLevel; level < offered.size(); ++level)
+					ret += offered[level];
+
+				return static_cast<double>(ret) / seconds;
+			};
+
+			auto written = loadAt(std::to_underlying(shed)) * seconds;
+			if (written != 0.0)
+				state.recordSize = static_cast<double>(bytes) / written;
+			state.throughput = { written / seconds, static_cast<double>(bytes) / seconds };
+
+			if (state.budget.recordsPerSecond == 0u && state.budget.bytesPerSecond == 0u) {
+				changes[i] = { shed, shed };
+				continue;
+			}
+
+			auto fits = [&state, &loadAt](std::size_t minLevel, double ratio) {
+				auto records = loadAt(minLevel);
+
+				return (state.budget.recordsPerSecond == 0u || records <= state.budget.recordsPerSecond * ratio)
+					&& (state.budget.bytesPerSecond == 0u || records * state.recordSize <= state.budget.bytesPerSecond * ratio);
+			};
+
+			auto level = std::to_underlying(shed);
+			if (!fits(level, 1.0)) {
+				// never past warnings, so errors always get through
+				while (level < std::to_underlying(log::LogLevel::Warn) && !fits(level, 1.0))
+					++level;
+			} else {
+				while (level > 0u && fits(level - 1u, kRestoreRatio))
+					--level;
+			}
+
+			// levels the sink doesn't take anyway aren't shedding
+			auto newShed = static_cast<log::LogLevel>(level);
+			if (newShed <= configured[i])
+				newShed = log::LogLevel::Debug;
+
+			state.shedLevel.store(newShed, std::memory_order_relaxed);
+			changes[i] = { shed, newShed };
+			throughputs[i] = state.throughput;
+		}
+	}
+
+	for (std::size_t i = 0u; i < changes.size(); ++i) {
+		auto [before, after] = changes[i];
+		if (before == after)
+			continue;
+
+		if (after == log::LogLevel::Debug) {
+			log::warn("[AURORA] {} output back within budget; shedding ended.", kSinkNames[i]);
+		} else {
+			log::warn(
+				"[AURORA] {} output {} ({:.0f} records/s, {:.1f} KB/s); shedding records below {}.",
+				kSinkNames[i], after > before ? "over budget" : "load dropped",
+				throughputs[i].recordsPerSecond, throughputs[i].bytesPerSecond / 1024.0,
+				kLevelNames[std::to_underlying(after)]
+			);
+		}
+	}
+
+	return;
+}
\ No newline at end of file
@@ -1,22 +1,292 @@
 #include <aurora/singletons/TargetManager.hpp>
 
 #include <aurora/log.hpp>
+#include <aurora/singletons/WriterManager.hpp>
+#include <aurora/singletons/ThreadManager.hpp>
+#include <aurora/LogIndex.hpp>
+#include <aurora/LogBlock.hpp>
+#include <aurora/LogSegment.hpp>
+
+#include "CrashLock.hpp"
 
 #include <filesystem>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
 #include <fstream>
 #include <cstring>
 #include <algorithm>
 #include <chrono>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+#include <cstdlib>
+#include <cerrno>
+
+#if defined(_WIN32)
+	#include <io.h>
+	#include <fcntl.h>
+	#include <sys/stat.h>
+#else
+	#include <fcntl.h>
+	#include <time.h>
+	#include <unistd.h>
+#endif
 
 using namespace aurora;
 
 
+namespace {
+
+int openForAppend(std::string const& pathToAFile, [[maybe_unused]] bool binary) noexcept {
+	#if defined(_WIN32)
+		return _open(
+			pathToAFile.c_str(),
+			_O_WRONLY | _O_APPEND | _O_CREAT | (binary ? _O_BINARY : _O_TEXT),
+			_S_IREAD | _S_IWRITE
+		);
+	#else
+		return ::open(pathToAFile.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+	#endif
+}
+
+void closeFile(int fd) noexcept {
+	#if defined(_WIN32)
+		_close(fd);
+	#else
+		::close(fd);
+	#endif
+}
+
+// async-signal-safe
+void writeAll(int fd, std::string_view data) noexcept {
+	while (!data.empty()) {
+		#if defined(_WIN32)
+			auto written = _write(fd, data.data(), static_cast<unsigned>(data.size()));
+		#else
+			auto written = ::write(fd, data.data(), data.size());
+		#endif
+
+		if (written < 0) {
+			if (errno == EINTR)
+				continue;
+			return;
+		}
+		data.remove_prefix(static_cast<std::size_t>(written));
+	}
+
+	return;
+}
+
+// @return Position of the file after seeking to @p whence, or 0 if it can't be told
+std::uint64_t seekFile(int fd, int whence) noexcept {
+	#if defined(_WIN32)
+		auto ret = _lseeki64(fd, 0, whence);
+	#else
+		auto ret = ::lseek(fd, 0, whence);
+	#endif
+
+	return ret < 0 ? 0u : static_cast<std::uint64_t>(ret);
+}
+
+// async-signal-safe
+void writeStoredBlock(int fd, LogBlock::Header const& header, std::string_view records) noexcept {
+	auto stored = LogBlock::storedHeader(header, records);
+
+	writeAll(fd, { reinterpret_cast<char const*>(&stored), sizeof(stored) });
+	writeAll(fd, records);
+
+	return;
+}
+
+// takes a flag held only while writing, giving up after a while in case the crashed thread holds it
+bool takeOnCrash([[maybe_unused]] std::atomic_bool& busy) noexcept {
+	#if defined(_WIN32)
+		return false;
+	#else
+		for (int i = 0; i < 100; ++i) {
+			if (!busy.exchange(true, std::memory_order_acquire))
+				return true;
+
+			timespec delay{ 0, 1'000'000 };
+			nanosleep(&delay, nullptr);
+		}
+
+		return false;
+	#endif
+}
+
+// records are written once this much is buffered
+constexpr std::size_t kSegmentBufferSize = 64u * 1024u;
+
+struct ThreadSegment;
+
+// segments of all threads, so the crash flush can write their buffers
+struct SegmentRegistry final {
+	CrashLock mutex{};
+	std::vector<ThreadSegment*> segments{};
+};
+
+SegmentRegistry& segmentRegistry() noexcept {
+	// never destroyed, as threads may exit after static destruction
+	static auto instance = new SegmentRegistry();
+
+	return *instance;
+}
+
+// a segment is only ever used by its own thread; the lock only keeps the crash flush out while it's being changed
+struct ThreadSegment final {
+	ThreadSegment() noexcept = default;
+	ThreadSegment(ThreadSegment const&) = delete;
+	ThreadSegment& operator=(ThreadSegment const&) = delete;
+	~ThreadSegment() noexcept {
+		// once it's out of the registry, nothing else touches it
+		if (registered) {
+			auto& registry = segmentRegistry();
+			std::lock_guard lock(registry.mutex);
+			std::erase(registry.segments, this);
+		}
+
+		this->close();
+	}
+
+	// uncontended, unless the process is crashing
+	void lock() noexcept {
+		while (busy.exchange(true, std::memory_order_acquire))
+			std::this_thread::yield();
+
+		return;
+	}
+	void unlock() noexcept {
+		busy.store(false, std::memory_order_release);
+
+		return;
+	}
+
+	void registerOnce() noexcept {
+		if (registered)
+			return;
+
+		auto& registry = segmentRegistry();
+		std::lock_guard lock(registry.mutex);
+		registry.segments.emplace_back(this);
+		owner = std::this_thread::get_id();
+		registered = true;
+
+		return;
+	}
+
+	// the caller holds the lock
+	void flush() noexcept {
+		if (fd != -1)
+			writeAll(fd, buffer);
+		buffer.clear();
+
+		return;
+	}
+
+	// the caller holds the lock
+	void close() noexcept {
+		if (fd == -1)
+			return;
+
+		this->flush();
+		closeFile(fd);
+		fd = -1;
+
+		return;
+	}
+
+	// generation of the segment settings the segment was opened with; 0 if never checked
+	std::uint64_t generation = 0u;
+	// set by other threads (under the registry lock) when only this thread has to reopen its segment
+	std::atomic_bool renew = false;
+	std::thread::id owner{};
+	bool registered = false;
+	std::atomic_bool busy = false;
+	int fd = -1;
+	std::string buffer{};
+};
+
+thread_local ThreadSegment t_segment;
+
+// a replaced ring is only reopened this often, as the collector may take a while to come back
+constexpr auto kReattachInterval = std::chrono::seconds(1);
+// the collector reports records dropped by its ring this often
+constexpr auto kDropReportInterval = std::chrono::seconds(10);
+
+// thread names may contain characters that aren't allowed in file names
+std::string segmentName(std::string_view threadName) noexcept {
+	std::string ret(threadName);
+
+	for (auto& c : ret) {
+		if (static_cast<unsigned char>(c) < 0x20u || std::string_view("<>:\"/\\|?*").contains(c))
+			c = '_';
+	}
+
+	return ret;
+}
+
+} // namespace
+
+
+TargetManager::File::~File() noexcept {
+	closeFile(fd);
+}
+
+
+struct TargetManager::IndexState final {
+	std::ofstream file;
+	LogIndex::Entry entry;
+};
+
+struct TargetManager::BlockState final {
+	std::shared_ptr<File> file;
+	LogBlock::Header header;
+	std::string records;
+};
+
+struct TargetManager::State final {
+	// guards the targets, the files, the indexes and the blocks being filled
+	mutable CrashLock mutex{};
+	std::flat_map<std::string, IndexState> indexes{};
+	std::flat_map<std::string, BlockState> blocks{};
+
+	// guards the blocks waiting for compression
+	CrashLock blocksMutex{};
+	std::condition_variable_any blocksNotEmpty{};
+	std::condition_variable_any blocksDrained{};
+	std::deque<BlockState> pendingBlocks{};
+	// blocks taken by the compressor, which compresses and writes them without the lock; `blocksDone` of them are written
+	std::vector<BlockState> compressingBlocks{};
+	std::atomic_size_t blocksDone = 0u;
+	// held while a block is written, so the crash flush never writes one in between or twice
+	std::atomic_bool writingBlock = false;
+};
+
+
 TargetManager* TargetManager::get() noexcept {
-	static auto instance = new TargetManager();
+	static auto instance = []() {
+		auto ret = new TargetManager();
+		std::atexit([]() {
+			// queued records still have to reach the files (and their indexes)
+			WriterManager::get()->flush();
+			TargetManager::get()->flushBlocks();
+			TargetManager::get()->closeIndexes();
+		});
+
+		return ret;
+	}();
 
 	return instance;
 }
 
+TargetManager::TargetManager() noexcept
+	: m_state(std::make_unique<State>()) {}
+
+TargetManager::~TargetManager() = default;
+
 
 bool TargetManager::canOpenFile(std::string_view pathToAFile) const noexcept {
 	namespace fs = std::filesystem;
@@ -56,11 +326,45 @@ bool TargetManager::canOpenFile(std::string_view pathToAFile) const noexcept {
 }
 
 
+TargetManager::Targets TargetManager::getLogTargets() const noexcept {
+	std::lock_guard lock(m_state->mutex);
+
+	return Targets(std::sorted_unique, m_logTargets.keys());
+}
+
+TargetManager::TargetConfigs TargetManager::getLogTargetConfigs() const noexcept {
+	std::lock_guard lock(m_state->mutex);
+
+	return m_logTargets;
+}
+
 bool TargetManager::addLogTarget(std::string_view pathToAFile) noexcept {
+	return this->addLogTarget(pathToAFile, TargetConfig{});
+}
+
+bool TargetManager::addLogTarget(std::string_view pathToAFile, TargetConfig const& config) noexcept {
 	if (!canOpenFile(pathToAFile))
 		return false;
 
-	auto [iter, inserted] = m_logTargets.emplace(pathToAFile);
+	std::string pathToAFileStr(pathToAFile);
+	int fd = openForAppend(pathToAFileStr, config.compressed);
+	if (fd == -1) {
+		log::warn(
+			"[AURORA] Failed to add log target '{}': {}.",
+			pathToAFile, std::strerror(errno)
+		);
+		return false;
+	}
+	auto file = std::make_shared<File>(fd);
+
+	bool inserted;
+	{
+		std::lock_guard lock(m_state->mutex);
+		inserted = m_logTargets.emplace(pathToAFileStr, config).second;
+		if (inserted)
+			m_files.emplace(pathToAFileStr, std::move(file));
+		this->updateFormats();
+	}
 	if (!inserted) {
 		log::warn(
 			"[AURORA] Failed to add log target '{}'; target already exists.",
@@ -75,9 +379,24 @@ bool TargetManager::addLogTarget(std::string_view pathToAFile) noexcept {
 }
 
 bool TargetManager::removeLogTarget(std::string_view pathToAFile) noexcept {
-	std::string pathToAFileStr(pathToAFile);
+	bool erased;
+	{
+		std::lock_guard lock(m_state->mutex);
+		std::string pathToAFileStr(pathToAFile);
+		erased = m_logTargets.erase(pathToAFileStr) != 0u;
+		m_files.erase(pathToAFileStr);
+		this->updateFormats();
 
-	if (!m_logTargets.contains(pathToAFileStr)) {
+		if (auto iter = m_state->indexes.find(pathToAFileStr); iter != m_state->indexes.end()) {
+			this->closeIndex(iter->second);
+			m_state->indexes.erase(iter);
+		}
+		if (auto iter = m_state->blocks.find(pathToAFileStr); iter != m_state->blocks.end()) {
+			this->sealBlock(iter->second);
+			m_state->blocks.erase(iter);
+		}
+	}
+	if (!erased) {
 		log::warn(
 			"[AURORA] Failed to remove log target '{}'; target doesn't exist.",
 			pathToAFile
@@ -85,8 +404,6 @@ bool TargetManager::removeLogTarget(std::string_view pathToAFile) noexcept {
 		return false;
 	}
 
-	m_logTargets.erase(pathToAFileStr);
-
 	log::info(
 		"[AURORA] Log target '{}' removed.",
 		pathToAFile
@@ -96,7 +413,20 @@ bool TargetManager::removeLogTarget(std::string_view pathToAFile) noexcept {
 }
 
 void TargetManager::clearLogTargets() noexcept {
-	m_logTargets.clear();
+	{
+		std::lock_guard lock(m_state->mutex);
+		m_logTargets.clear();
+		m_files.clear();
+		this->updateFormats();
+
+		for (auto& [filename, state] : m_state->indexes)
+			this->closeIndex(state);
+		m_state->indexes.clear();
+
+		for (auto& [filename, state] : m_state->blocks)
+			this->sealBlock(state);
+		m_state->blocks.clear();
+	}
 
 	log::info("[AURORA] Log targets reset.");
 
@@ -118,6 +448,14 @@ void TargetManager::setMaxFilesInADir(std::uint16_t fileCount) noexcept {
 std::optional<std::string> TargetManager::logToDir(
 	std::string_view directory,
 	std::string_view filename
+) noexcept {
+	return this->logToDir(directory, filename, TargetConfig{});
+}
+
+std::optional<std::string> TargetManager::logToDir(
+	std::string_view directory,
+	std::string_view filename,
+	TargetConfig const& config
 ) noexcept {
 	namespace fs = std::filesystem;
 	namespace ch = std::chrono;
@@ -128,8 +466,14 @@ std::optional<std::string> TargetManager::logToDir(
 		return std::nullopt;
 
 	std::vector<fs::directory_entry> dirVec{};
-	for (auto const& file : fs::directory_iterator(dir))
-		dirVec.emplace_back(file);
+	std::vector<fs::path> segments{};
+	for (auto const& file : fs::directory_iterator(dir)) {
+		// indexes and segments go together with their log files
+		if (file.path().extension() == LogSegment::kExtension)
+			segments.emplace_back(file.path());
+		else if (file.path().extension() != ".idx")
+			dirVec.emplace_back(file);
+	}
 
 	if (dirVec.size() >= m_maxFilesInADir) {
 		std::ranges::sort(
@@ -153,6 +497,16 @@ std::optional<std::string> TargetManager::logToDir(
 					dirVec[i].path().filename().string(), std::strerror(errno)
 				);
 			}
+
+			std::error_code err;
+			fs::remove(LogIndex::pathFor(dirVec[i].path().string()), err);
+
+			// `<filename> <date> [<thread name>].seg` for `<filename> <date>.log`
+			auto segmentPrefix = dirVec[i].path().stem().string() + " [";
+			for (auto const& segment : segments) {
+				if (segment.filename().string().starts_with(segmentPrefix))
+					fs::remove(segment, err);
+			}
 		}
 	}
 
@@ -170,11 +524,820 @@ std::optional<std::string> TargetManager::logToDir(
 	stream << std::put_time(&localTime, "%F %H.%M.%OS");
 
 	auto target = (dir/std::format(
-		"{} {}.log",
-		filename, stream.str()
+		"{} {}.{}",
+		filename, stream.str(), config.compressed ? "alz" : "log"
 	)).string();
 
-	this->addLogTarget(target);
+	this->addLogTarget(target, config);
+
+	{
+		std::lock_guard lock(m_state->mutex);
+		m_segmentsPrefix = (dir/std::format("{} {}", filename, stream.str())).string();
+		m_segmentsTarget = target;
+	}
+	this->renewThreadSegments();
 
 	return std::move(target);
+}
+
+
+bool TargetManager::logToSharedRing(std::string_view name) noexcept {
+	std::shared_ptr<SharedRing> ring = SharedRing::open(name);
+	if (!ring)
+		return false;
+
+	this->detachSharedRing();
+	m_crashRing.store(ring.get(), std::memory_order_relaxed);
+	m_ring.store(std::move(ring));
+	this->renewThreadSegments();
+
+	log::info("[AURORA] Logging to shared ring '{}'.", name);
+
+	return true;
+}
+
+std::optional<std::string> TargetManager::collectSharedRing(
+	std::string_view name,
+	std::string_view directory,
+	std::string_view filename,
+	std::uint32_t slotCount,
+	std::uint32_t slotSize
+) noexcept {
+	this->detachSharedRing();
+
+	auto target = this->logToDir(directory, filename);
+	if (!target)
+		return std::nullopt;
+
+	std::shared_ptr<SharedRing> ring = SharedRing::create(name, slotCount, slotSize);
+	if (!ring)
+		return std::nullopt;
+
+	m_collector = std::jthread([this, ring](std::stop_token stop) {
+		namespace ch = std::chrono;
+
+		std::string record;
+		std::uint64_t reported = 0u;
+		auto nextReport = ch::steady_clock::now() + kDropReportInterval;
+
+		auto reportDrops = [&ring, &reported]() {
+			auto dropped = ring->getDroppedCount();
+			if (dropped == reported)
+				return;
+
+			log::warn(
+				"[AURORA] Shared ring '{}' dropped {} record(s) ({} in total).",
+				ring->getName(), dropped - reported, dropped
+			);
+			reported = dropped;
+		};
+
+		while (true) {
+			bool drained = true;
+			while (auto entry = ring->pop(record)) {
+				this->writeToTargets(entry->logLevel, entry->time, record, record);
+				drained = false;
+			}
+
+			// everything pushed before the stop request is still written
+			if (stop.stop_requested())
+				break;
+
+			if (auto now = ch::steady_clock::now(); now >= nextReport) {
+				reportDrops();
+				nextReport = now + kDropReportInterval;
+			}
+
+			if (drained)
+				std::this_thread::sleep_for(ch::milliseconds(1));
+		}
+
+		reportDrops();
+	});
+	m_crashRing.store(ring.get(), std::memory_order_relaxed);
+	m_ring.store(std::move(ring));
+	this->renewThreadSegments();
+
+	log::info("[AURORA] Collecting shared ring '{}' into '{}'.", name, *target);
+
+	return target;
+}
+
+void TargetManager::detachSharedRing() noexcept {
+	auto ring = m_ring.exchange(nullptr);
+	m_crashRing.store(nullptr, std::memory_order_relaxed);
+	this->renewThreadSegments();
+
+	if (m_collector.joinable()) {
+		m_collector.request_stop();
+		m_collector.join();
+	}
+
+	if (ring)
+		log::info("[AURORA] Detached from shared ring '{}'.", ring->getName());
+
+	return;
+}
+
+std::shared_ptr<SharedRing> TargetManager::reattachSharedRing(std::shared_ptr<SharedRing> retired) noexcept {
+	namespace ch = std::chrono;
+
+	auto now = ch::duration_cast<ch::nanoseconds>(ch::steady_clock::now().time_since_epoch()).count();
+	auto last = m_ringReattach.load(std::memory_order_relaxed);
+	if (
+		now - last < ch::nanoseconds(kReattachInterval).count()
+		|| !m_ringReattach.compare_exchange_strong(last, now, std::memory_order_relaxed)
+	)
+		return nullptr;
+
+	std::shared_ptr<SharedRing> ring = retired->reopen();
+	if (!ring)
+		return nullptr;
+
+	// the ring may have been detached or reattached by another thread in the meantime
+	auto retiredPtr = retired.get();
+	if (!m_ring.compare_exchange_strong(retired, ring))
+		return retired;
+	m_crashRing.compare_exchange_strong(retiredPtr, ring.get(), std::memory_order_relaxed);
+
+	return ring;
+}
+
+
+std::uint8_t TargetManager::formatsFor(log::LogLevel logLevel) noexcept {
+	// the collector filters records of a ring against its own targets
+	if (m_ring.load(std::memory_order_relaxed))
+		return logLevel >= log::getFileLogLevel() ? 1u << std::to_underlying(Format::Plain) : 0u;
+
+	auto formats = m_formats[std::to_underlying(logLevel)].load(std::memory_order_relaxed);
+	if (logLevel >= log::getFileLogLevel())
+		formats |= m_fileLevelFormats.load(std::memory_order_relaxed);
+	// segments take the place of the only target, so they take plain records of the levels it takes
+	if (formats != 0u && this->hasThreadSegment())
+		return 1u << std::to_underlying(Format::Plain);
+
+	return formats;
+}
+
+log::LogLevel TargetManager::lowestLogLevel() const noexcept {
+	auto fileLogLevel = log::getFileLogLevel();
+	// producers of a ring only push what passes the file logging level
+	if (m_ring.load(std::memory_order_relaxed))
+		return fileLogLevel;
+
+	bool following = m_fileLevelFormats.load(std::memory_order_relaxed) != 0u;
+	for (std::uint8_t i = 0u; i < m_formats.size(); ++i) {
+		auto logLevel = static_cast<log::LogLevel>(i);
+
+		if (m_formats[i].load(std::memory_order_relaxed) != 0u || (following && logLevel >= fileLogLevel))
+			return logLevel;
+	}
+
+	return fileLogLevel;
+}
+
+void TargetManager::updateFormats() noexcept {
+	std::array<std::uint8_t, 4u> formats{};
+	std::uint8_t fileLevelFormats = 0u;
+
+	for (auto const& [filename, config] : m_logTargets) {
+		if (!config.logLevel) {
+			fileLevelFormats |= 1u << std::to_underlying(config.format);
+			continue;
+		}
+
+		for (auto i = std::to_underlying(*config.logLevel); i < formats.size(); ++i)
+			formats[i] |= 1u << std::to_underlying(config.format);
+	}
+
+	for (std::size_t i = 0u; i < formats.size(); ++i)
+		m_formats[i].store(formats[i], std::memory_order_relaxed);
+	m_fileLevelFormats.store(fileLevelFormats, std::memory_order_relaxed);
+
+	// a change of targets may suspend or resume segments
+	this->renewThreadSegments();
+
+	return;
+}
+
+void TargetManager::writeRecord(
+	log::LogLevel logLevel,
+	std::chrono::system_clock::time_point time,
+	std::string_view plain,
+	std::string_view ansi
+) noexcept {
+	if (auto ring = m_ring.load()) {
+		if (!ring->push(logLevel, time, plain) && ring->isRetired()) {
+			if (auto next = this->reattachSharedRing(std::move(ring)))
+				next->push(logLevel, time, plain);
+		}
+		return;
+	}
+
+	this->writeToTargets(logLevel, time, plain, ansi);
+
+	return;
+}
+
+void TargetManager::writeToTargets(
+	log::LogLevel logLevel,
+	std::chrono::system_clock::time_point time,
+	std::string_view plain,
+	std::string_view ansi,
+	bool first,
+	bool last
+) noexcept {
+	std::lock_guard lock(m_state->mutex);
+
+	bool indexing = m_indexRecords != 0u || m_indexKilobytes != 0u;
+
+	for (auto const& [filename, config] : m_logTargets) {
+		if (logLevel < config.logLevel.value_or(log::getFileLogLevel()))
+			continue;
+
+		auto string = config.format == Format::ANSI ? ansi : plain;
+
+		if (config.compressed) {
+			this->appendToBlock(filename, logLevel, time, string, first, last);
+			continue;
+		}
+
+		auto file = m_files.find(filename);
+		if (file == m_files.end())
+			continue;
+
+		int fd = file->second->fd;
+		if (!indexing) {
+			writeAll(fd, string);
+			continue;
+		}
+
+		// offsets are read from the file, so they can't drift from what was written (e.g. after failed writes or newline translation)
+		auto begin = seekFile(fd, SEEK_END);
+		writeAll(fd, string);
+		this->indexRecord(filename, logLevel, time, begin, seekFile(fd, SEEK_CUR), first, last);
+	}
+
+	return;
+}
+
+
+std::pair<std::uint32_t, std::uint32_t> TargetManager::getIndexInterval() const noexcept {
+	std::lock_guard lock(m_state->mutex);
+
+	return { m_indexRecords, m_indexKilobytes };
+}
+
+void TargetManager::setIndexInterval(std::uint32_t records, std::uint32_t kilobytes) noexcept {
+	std::lock_guard lock(m_state->mutex);
+
+	m_indexRecords = records;
+	m_indexKilobytes = kilobytes;
+	// indexed targets suspend segments
+	this->renewThreadSegments();
+
+	if (records == 0u && kilobytes == 0u) {
+		for (auto& [filename, state] : m_state->indexes)
+			this->closeIndex(state);
+		m_state->indexes.clear();
+	}
+
+	return;
+}
+
+void TargetManager::indexRecord(
+	std::string const& pathToAFile,
+	log::LogLevel logLevel,
+	std::chrono::system_clock::time_point time,
+	std::uint64_t begin,
+	std::uint64_t end,
+	bool first,
+	bool last
+) noexcept {
+	namespace fs = std::filesystem;
+	namespace ch = std::chrono;
+
+	auto iter = m_state->indexes.find(pathToAFile);
+	if (iter == m_state->indexes.end()) {
+		auto indexPath = LogIndex::pathFor(pathToAFile);
+
+		std::error_code indexErr;
+		auto indexSize = fs::file_size(indexPath, indexErr);
+
+		IndexState state{
+			std::ofstream(indexPath, std::ios::binary | std::ios::app),
+			{}
+		};
+		if (!state.file.is_open())
+			return;
+		if (indexErr || indexSize == 0u)
+			state.file.write(LogIndex::kMagic, sizeof(LogIndex::kMagic));
+
+		iter = m_state->indexes.emplace(pathToAFile, std::move(state)).first;
+	}
+
+	auto& state = iter->second;
+	auto& entry = state.entry;
+	auto ns = ch::duration_cast<ch::nanoseconds>(time.time_since_epoch()).count();
+	// parts of a record after the first one only add to its size
+	bool newRecord = first || entry.recordCount == 0u;
+
+	if (entry.recordCount == 0u) {
+		entry.firstTime = ns;
+		entry.lastTime = ns;
+		entry.offset = begin;
+	}
+	entry.firstTime = std::min(entry.firstTime, ns);
+	entry.lastTime = std::max(entry.lastTime, ns);
+	entry.size = std::max(end, entry.offset) - entry.offset;
+	if (newRecord) {
+		entry.levelMask |= 1u << std::to_underlying(logLevel);
+		++entry.recordCount;
+	}
+
+	// entries only end between records
+	if (
+		last && (
+			(m_indexRecords != 0u && entry.recordCount >= m_indexRecords)
+			|| (m_indexKilobytes != 0u && entry.size >= m_indexKilobytes * 1024ull)
+		)
+	)
+		this->closeIndex(state);
+
+	return;
+}
+
+void TargetManager::closeIndex(IndexState& state) noexcept {
+	if (state.entry.recordCount != 0u)
+		state.file.write(reinterpret_cast<char const*>(&state.entry), sizeof(state.entry));
+	state.file.flush();
+
+	state.entry = {};
+
+	return;
+}
+
+void TargetManager::closeIndexes() noexcept {
+	std::lock_guard lock(m_state->mutex);
+
+	for (auto& [filename, state] : m_state->indexes)
+		this->closeIndex(state);
+
+	return;
+}
+
+
+std::uint32_t TargetManager::getBlockSize() const noexcept {
+	std::lock_guard lock(m_state->mutex);
+
+	return m_blockKilobytes;
+}
+
+void TargetManager::setBlockSize(std::uint32_t kilobytes) noexcept {
+	constexpr std::uint32_t kMaxKilobytes = LogBlock::kMaxRawSize / 1024u;
+
+	if (kilobytes == 0u) {
+		log::warn("[AURORA] Can't set block size to 0.");
+		return;
+	}
+	if (kilobytes > kMaxKilobytes) {
+		log::warn("[AURORA] Block size of {} KB is too large; using {} KB.", kilobytes, kMaxKilobytes);
+		kilobytes = kMaxKilobytes;
+	}
+
+	std::lock_guard lock(m_state->mutex);
+	m_blockKilobytes = kilobytes;
+
+	return;
+}
+
+void TargetManager::appendToBlock(
+	std::string const& pathToAFile,
+	log::LogLevel logLevel,
+	std::chrono::system_clock::time_point time,
+	std::string_view record,
+	bool first,
+	bool last
+) noexcept {
+	namespace ch = std::chrono;
+
+	auto& state = m_state->blocks[pathToAFile];
+	if (!state.file) {
+		auto file = m_files.find(pathToAFile);
+		if (file == m_files.end())
+			return;
+
+		state.file = file->second;
+	}
+
+	auto ns = ch::duration_cast<ch::nanoseconds>(time.time_since_epoch()).count();
+	auto append = [&state, logLevel, ns](std::string_view part, bool first) {
+		auto& header = state.header;
+		// parts of a record after the first one only add to its size
+		bool newRecord = first || header.recordCount == 0u;
+
+		if (header.recordCount == 0u) {
+			header.firstTime = ns;
+			header.lastTime = ns;
+		}
+		header.firstTime = std::min(header.firstTime, ns);
+		header.lastTime = std::max(header.lastTime, ns);
+		if (newRecord) {
+			header.levelMask |= 1u << std::to_underlying(logLevel);
+			++header.recordCount;
+		}
+
+		state.records.append(part);
+	};
+
+	std::size_t blockSize = m_blockKilobytes * 1024u;
+
+	// blocks are sealed between records, before one would outgrow them, so a record isn't split across blocks...
+	if (first && !state.records.empty() && state.records.size() + record.size() > blockSize)
+		this->sealBlock(state);
+
+	// ...unless it outgrows the largest block on its own
+	while (state.records.size() + record.size() > LogBlock::kMaxRawSize) {
+		auto part = record.substr(0u, LogBlock::kMaxRawSize - state.records.size());
+		append(part, first);
+		this->sealBlock(state);
+
+		record.remove_prefix(part.size());
+		first = false;
+	}
+
+	append(record, first);
+
+	if (last && state.records.size() >= blockSize)
+		this->sealBlock(state);
+
+	return;
+}
+
+// only queues the block; compression and writing happen on the compressor thread
+void TargetManager::sealBlock(BlockState& state) noexcept {
+	if (state.header.recordCount == 0u)
+		return;
+
+	{
+		std::lock_guard lock(m_state->blocksMutex);
+
+		m_state->pendingBlocks.emplace_back(state.file, state.header, std::move(state.records));
+
+		if (!m_compressor.joinable())
+			m_compressor = std::jthread([this](std::stop_token stop) { this->compressBlocks(stop); });
+	}
+	m_state->blocksNotEmpty.notify_one();
+
+	state.header = {};
+	state.records = {};
+
+	return;
+}
+
+void TargetManager::flushBlocks() noexcept {
+	{
+		std::lock_guard lock(m_state->mutex);
+
+		for (auto& [filename, state] : m_state->blocks)
+			this->sealBlock(state);
+	}
+
+	std::unique_lock lock(m_state->blocksMutex);
+	m_state->blocksDrained.wait(lock, [this]() { return m_state->pendingBlocks.empty() && !m_compressing; });
+
+	return;
+}
+
+void TargetManager::compressBlocks(std::stop_token stop) noexcept {
+	std::string encoded;
+	std::unique_lock lock(m_state->blocksMutex);
+
+	while (true) {
+		m_state->blocksNotEmpty.wait(lock, stop, [this]() { return !m_state->pendingBlocks.empty(); });
+		if (m_state->pendingBlocks.empty())
+			break;
+
+		// blocks sealed meanwhile only wait for the lock, not for compression or the disk
+		m_state->compressingBlocks.assign(
+			std::make_move_iterator(m_state->pendingBlocks.begin()),
+			std::make_move_iterator(m_state->pendingBlocks.end())
+		);
+		m_state->pendingBlocks.clear();
+		m_state->blocksDone.store(0u, std::memory_order_relaxed);
+		m_compressing = true;
+		lock.unlock();
+
+		for (auto const& block : m_state->compressingBlocks) {
+			LogBlock::encode(block.header, block.records, encoded);
+
+			while (m_state->writingBlock.exchange(true, std::memory_order_acquire))
+				std::this_thread::yield();
+			writeAll(block.file->fd, encoded);
+			m_state->blocksDone.fetch_add(1u, std::memory_order_relaxed);
+			m_state->writingBlock.store(false, std::memory_order_release);
+		}
+
+		lock.lock();
+		m_state->compressingBlocks.clear();
+		m_compressing = false;
+		m_state->blocksDrained.notify_all();
+	}
+
+	return;
+}
+
+
+bool TargetManager::getThreadSegmentsEnabled() const noexcept {
+	return m_segments.load(std::memory_order_relaxed);
+}
+
+bool TargetManager::setThreadSegmentsEnabled(bool on) noexcept {
+	bool hasDir;
+	{
+		std::lock_guard lock(m_state->mutex);
+
+		hasDir = !m_segmentsPrefix.empty();
+		if (hasDir || !on)
+			m_segments.store(on, std::memory_order_relaxed);
+	}
+	if (on && !hasDir) {
+		log::warn("[AURORA] Can't enable thread segments without an auto-managed directory.");
+		return false;
+	}
+
+	this->renewThreadSegments();
+
+	bool usable;
+	{
+		std::lock_guard lock(m_state->mutex);
+		usable = this->segmentsUsable();
+	}
+	// reported here rather than by the first thread to notice
+	m_segmentsSuspended.store(on && !usable, std::memory_order_relaxed);
+	if (on && !usable) {
+		log::warn(
+			"[AURORA] Thread segments are suspended while the log of the auto-managed directory isn't the only target, "
+			"is compressed or indexed, or output goes to a shared ring."
+		);
+	}
+
+	return true;
+}
+
+bool TargetManager::segmentsUsable() const noexcept {
+	if (!m_segments.load(std::memory_order_relaxed) || m_ring.load(std::memory_order_relaxed))
+		return false;
+	if (m_logTargets.size() != 1u || m_indexRecords != 0u || m_indexKilobytes != 0u)
+		return false;
+
+	auto iter = m_logTargets.find(m_segmentsTarget);
+
+	return iter != m_logTargets.end() && !iter->second.compressed;
+}
+
+void TargetManager::flushThreadSegment() noexcept {
+	std::lock_guard lock(t_segment);
+	t_segment.flush();
+
+	return;
+}
+
+bool TargetManager::hasThreadSegment() noexcept {
+	// only named threads get segments, and there's nothing to open (or close) while they're off
+	if (!t_segment.registered || (t_segment.fd == -1 && !m_segments.load(std::memory_order_relaxed)))
+		return false;
+
+	// the only shared state on the way to a segment; it's written rarely, so its cache lines stay shared
+	auto generation = m_segmentsGeneration.load(std::memory_order_acquire);
+	if (t_segment.generation != generation || t_segment.renew.load(std::memory_order_acquire))
+		this->openThreadSegment(generation);
+
+	return t_segment.fd != -1;
+}
+
+void TargetManager::openThreadSegment(std::uint64_t generation) noexcept {
+	namespace fs = std::filesystem;
+
+	t_segment.renew.store(false, std::memory_order_relaxed);
+	{
+		std::lock_guard lock(t_segment);
+		t_segment.close();
+	}
+	// set first, so records logged from here on don't come back here
+	t_segment.generation = generation;
+
+	std::string path;
+	bool usable;
+	{
+		std::lock_guard lock(m_state->mutex);
+
+		usable = this->segmentsUsable();
+		if (auto threadName = ThreadManager::get()->getThreadNameByID(std::this_thread::get_id()); usable && threadName)
+			path = std::format("{} [{}]{}", m_segmentsPrefix, segmentName(*threadName), LogSegment::kExtension);
+	}
+
+	// logged without the lock, as the record goes to the targets. Only the first thread to notice a change reports it
+	bool suspended = m_segments.load(std::memory_order_relaxed) && !usable;
+	if (m_segmentsSuspended.exchange(suspended, std::memory_order_relaxed) != suspended) {
+		if (suspended) {
+			log::info(
+				"[AURORA] Thread segments suspended; records go to the targets while the log of the auto-managed directory isn't the only target, "
+				"is compressed or indexed, or output goes to a shared ring."
+			);
+		} else {
+			log::info("[AURORA] Thread segments resumed.");
+		}
+	}
+
+	if (path.empty())
+		return;
+
+	std::error_code err;
+	auto size = fs::file_size(path, err);
+
+	int fd = openForAppend(path, true);
+	if (fd == -1) {
+		log::warn(
+			"[AURORA] Failed to open thread segment '{}': {}.",
+			path, std::strerror(errno)
+		);
+		return;
+	}
+	if (err || size == 0u)
+		writeAll(fd, { LogSegment::kMagic, sizeof(LogSegment::kMagic) });
+
+	std::lock_guard lock(t_segment);
+	t_segment.fd = fd;
+	t_segment.buffer.reserve(kSegmentBufferSize + 1024u);
+
+	return;
+}
+
+bool TargetManager::writeToThreadSegment(
+	log::LogLevel logLevel,
+	std::chrono::system_clock::time_point time,
+	std::string_view record
+) noexcept {
+	namespace ch = std::chrono;
+
+	if (!this->hasThreadSegment())
+		return false;
+
+	LogSegment::RecordHeader header{};
+	header.time = ch::duration_cast<ch::nanoseconds>(time.time_since_epoch()).count();
+	header.size = static_cast<std::uint32_t>(record.size());
+	header.logLevel = logLevel;
+
+	std::lock_guard lock(t_segment);
+	t_segment.buffer.append(reinterpret_cast<char const*>(&header), sizeof(header));
+	t_segment.buffer.append(record);
+
+	if (t_segment.buffer.size() >= kSegmentBufferSize)
+		t_segment.flush();
+
+	return true;
+}
+
+void TargetManager::renewThreadSegments() noexcept {
+	m_segmentsGeneration.fetch_add(1u, std::memory_order_release);
+
+	return;
+}
+
+void TargetManager::registerThreadSegment() noexcept {
+	t_segment.registerOnce();
+	t_segment.renew.store(true, std::memory_order_release);
+
+	return;
+}
+
+void TargetManager::renewThreadSegment(std::thread::id id) noexcept {
+	auto& registry = segmentRegistry();
+	std::lock_guard lock(registry.mutex);
+
+	// a thread that hasn't logged yet opens its segment on its first record anyway
+	for (auto segment : registry.segments) {
+		if (segment->owner == id)
+			segment->renew.store(true, std::memory_order_release);
+	}
+
+	return;
+}
+
+
+void TargetManager::prepareCrashFlush() noexcept {
+	[[maybe_unused]] auto& registry = segmentRegistry();
+
+	return;
+}
+
+bool TargetManager::tryLockTargetsOnCrash() noexcept {
+	return m_state->mutex.tryLockOnCrash();
+}
+
+bool TargetManager::tryLockBlocksOnCrash() noexcept {
+	return m_state->blocksMutex.tryLockOnCrash();
+}
+
+void TargetManager::unlockOnCrash(bool blocksLocked) noexcept {
+	if (blocksLocked)
+		m_state->blocksMutex.unlockOnCrash();
+	m_state->mutex.unlockOnCrash();
+
+	return;
+}
+
+bool TargetManager::tryLockSegmentsOnCrash() noexcept {
+	return segmentRegistry().mutex.tryLockOnCrash();
+}
+
+void TargetManager::unlockSegmentsOnCrash() noexcept {
+	segmentRegistry().mutex.unlockOnCrash();
+
+	return;
+}
+
+void TargetManager::writeSegmentsOnCrash() noexcept {
+	#if !defined(_WIN32)
+		for (auto segment : segmentRegistry().segments) {
+			// a segment left locked by the crashed thread itself is skipped
+			if (!takeOnCrash(segment->busy))
+				continue;
+
+			// clear() keeps the capacity, so nothing is freed here
+			segment->flush();
+			segment->unlock();
+		}
+	#endif
+
+	return;
+}
+
+void TargetManager::writeBlocksOnCrash() noexcept {
+	// blocks are written stored, in the order they would have been written in.
+	// The flag is kept, so the compressor doesn't write what's left of its batch once more
+	if (m_compressing && takeOnCrash(m_state->writingBlock)) {
+		auto const& batch = m_state->compressingBlocks;
+
+		for (auto i = m_state->blocksDone.load(std::memory_order_relaxed); i < batch.size(); ++i)
+			writeStoredBlock(batch[i].file->fd, batch[i].header, batch[i].records);
+	}
+
+	for (auto const& block : m_state->pendingBlocks)
+		writeStoredBlock(block.file->fd, block.header, block.records);
+
+	for (auto& [filename, state] : m_state->blocks) {
+		if (state.header.recordCount == 0u)
+			continue;
+
+		writeStoredBlock(state.file->fd, state.header, state.records);
+
+		// clear() keeps the capacity, so nothing is freed here
+		state.header = {};
+		state.records.clear();
+	}
+
+	return;
+}
+
+void TargetManager::writeRecordOnCrash(
+	log::LogLevel logLevel,
+	std::chrono::system_clock::time_point time,
+	std::string_view plain,
+	std::string_view ansi
+) noexcept {
+	namespace ch = std::chrono;
+
+	if (auto ring = m_crashRing.load(std::memory_order_relaxed)) {
+		ring->push(logLevel, time, plain);
+		return;
+	}
+
+	for (auto const& [filename, config] : m_logTargets) {
+		if (logLevel < config.logLevel.value_or(log::getFileLogLevel()))
+			continue;
+
+		auto file = m_files.find(filename);
+		if (file == m_files.end())
+			continue;
+
+		auto string = config.format == Format::ANSI ? ansi : plain;
+
+		if (!config.compressed) {
+			writeAll(file->second->fd, string);
+			continue;
+		}
+
+		// open blocks are already written, so the record gets a block of its own
+		LogBlock::Header header{};
+		header.levelMask = static_cast<std::uint8_t>(1u << std::to_underlying(logLevel));
+		header.recordCount = 1u;
+		header.firstTime = ch::duration_cast<ch::nanoseconds>(time.time_since_epoch()).count();
+		header.lastTime = header.firstTime;
+
+		writeStoredBlock(file->second->fd, header, string);
+	}
+
+	return;
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include <aurora/singletons/ThreadManager.hpp>
 
 #include <aurora/log.hpp>
+#include <aurora/singletons/TargetManager.hpp>
 
 using namespace aurora;
 
@@ -26,6 +27,8 @@ bool ThreadManager::addThread(std::string_view threadName) noexcept {
 
 	m_dbID_S.emplace(id, *iter);
 	m_dbS_ID.emplace(*iter, id);
+	// segments are named after their threads
+	TargetManager::get()->registerThreadSegment();
 
 	log::debug("[AURORA] Thread {} saved as '{}'.", id, threadName);
 
@@ -47,6 +50,7 @@ bool ThreadManager::removeThread(std::thread::id id) noexcept {
 	m_dbID_S.erase(id);
 
 	m_strDB.erase(str);
+	TargetManager::get()->renewThreadSegment(id);
 
 	log::debug(
 		"[AURORA] Thread '{}' ({}) removed.",
@@ -71,6 +75,7 @@ bool ThreadManager::removeThread(std::string_view str) noexcept {
 	m_dbS_ID.erase(str);
 
 	m_strDB.erase(std::string(str));
+	TargetManager::get()->renewThreadSegment(id);
 
 	log::debug(
 		"[AURORA] Thread '{}' ({}) removed.",
@@ -85,6 +90,7 @@ void ThreadManager::clearDB() noexcept {
 	m_dbS_ID.clear();
 
 	m_strDB.clear();
+	TargetManager::get()->renewThreadSegments();
 
 	log::debug("[AURORA] Thread name databases reset.");
 
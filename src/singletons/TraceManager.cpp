@@ -0,0 +1,203 @@
+#include <aurora/singletons/TraceManager.hpp>
+
+#include <aurora/singletons/ThreadManager.hpp>
+#include <aurora/log.hpp>
+
+#include <mutex>
+#include <fstream>
+#include <cstring>
+#include <iterator>
+#include <cstdlib>
+
+#if defined(_MSC_VER)
+	#include <process.h>
+#else
+	#include <unistd.h>
+#endif
+
+using namespace aurora;
+
+
+namespace {
+
+void appendEscaped(std::string& out, std::string_view str) noexcept {
+	for (char c : str) {
+		switch (c) {
+			case '"':
+				out += "\\\"";
+				break;
+
+			case '\\':
+				out += "\\\\";
+				break;
+
+			default:
+				if (static_cast<unsigned char>(c) < 0x20u)
+					std::format_to(std::back_inserter(out), "\\u{:04x}", static_cast<unsigned>(c));
+				else
+					out += c;
+		}
+	}
+
+	return;
+}
+
+int processID() noexcept {
+	#if defined(_MSC_VER)
+		return _getpid();
+	#else
+		return getpid();
+	#endif
+}
+
+constexpr std::size_t kFlushThreshold = 64u * 1024u;
+
+} // namespace
+
+
+struct TraceManager::State final {
+	std::mutex mutex{};
+	std::ofstream file{};
+};
+
+
+TraceManager* TraceManager::get() noexcept {
+	static auto instance = []() {
+		auto ret = new TraceManager();
+		std::atexit([]() { TraceManager::get()->flush(); });
+
+		return ret;
+	}();
+
+	return instance;
+}
+
+TraceManager::TraceManager() noexcept
+	: m_state(std::make_unique<State>()) {}
+
+TraceManager::~TraceManager() = default;
+
+
+std::optional<std::string> TraceManager::getTraceTarget() const noexcept {
+	std::lock_guard lock(m_state->mutex);
+
+	if (!m_state->file.is_open())
+		return std::nullopt;
+
+	return m_path;
+}
+
+bool TraceManager::setTraceTarget(std::string_view pathToAFile) noexcept {
+	this->clearTraceTarget();
+
+	{
+		std::lock_guard lock(m_state->mutex);
+
+		m_state->file.open(std::string(pathToAFile), std::ios::trunc);
+		if (!m_state->file.is_open()) {
+			log::warn(
+				"[AURORA] Failed to set trace target '{}': {}.",
+				pathToAFile, std::strerror(errno)
+			);
+			return false;
+		}
+
+		m_path = pathToAFile;
+		m_epoch = Clock::now();
+		m_tracks.clear();
+		m_buffer = "[\n";
+		m_tracing.store(true, std::memory_order_relaxed);
+	}
+
+	log::info("[AURORA] Trace target '{}' set.", pathToAFile);
+
+	return true;
+}
+
+void TraceManager::clearTraceTarget() noexcept {
+	{
+		std::lock_guard lock(m_state->mutex);
+
+		if (!m_state->file.is_open())
+			return;
+
+		m_tracing.store(false, std::memory_order_relaxed);
+		m_state->file << m_buffer;
+		m_state->file.close();
+		m_buffer.clear();
+	}
+
+	log::info("[AURORA] Trace target reset.");
+
+	return;
+}
+
+
+void TraceManager::addSpan(std::string_view name, Clock::time_point begin, Clock::time_point end) noexcept {
+	namespace ch = std::chrono;
+
+	if (!this->isTracing())
+		return;
+
+	std::lock_guard lock(m_state->mutex);
+
+	if (!m_state->file.is_open())
+		return;
+
+	auto tid = this->trackFor(std::this_thread::get_id());
+
+	m_buffer += R"({"name":")";
+	appendEscaped(m_buffer, name);
+	std::format_to(
+		std::back_inserter(m_buffer),
+		R"(","cat":"aurora","ph":"X","ts":{:.3f},"dur":{:.3f},"pid":{},"tid":{}}},)" "\n",
+		ch::duration<double, std::micro>(begin - m_epoch).count(),
+		ch::duration<double, std::micro>(end - begin).count(),
+		processID(), tid
+	);
+
+	if (m_buffer.size() >= kFlushThreshold) {
+		m_state->file << m_buffer;
+		m_buffer.clear();
+	}
+
+	return;
+}
+
+
+void TraceManager::flush() noexcept {
+	std::lock_guard lock(m_state->mutex);
+
+	if (!m_state->file.is_open())
+		return;
+
+	m_state->file << m_buffer;
+	m_state->file.flush();
+	m_buffer.clear();
+
+	return;
+}
+
+std::uint32_t TraceManager::trackFor(std::thread::id id) noexcept {
+	auto iter = m_tracks.find(id);
+	if (iter == m_tracks.end())
+		iter = m_tracks.emplace(id, std::pair(static_cast<std::uint32_t>(m_tracks.size() + 1u), std::string())).first;
+
+	auto& [tid, emittedName] = iter->second;
+
+	// thread names can be added after the first span, so the metadata is re-emitted on change
+	auto name = ThreadManager::get()->getThreadNameByID(id)
+		.transform([](std::string_view name) { return std::string(name); })
+		.value_or(std::format("Thread {}", id));
+
+	if (name != emittedName) {
+		m_buffer += R"({"name":"thread_name","ph":"M","pid":)";
+		std::format_to(std::back_inserter(m_buffer), R"({},"tid":{},"args":{{"name":")", processID(), tid);
+		appendEscaped(m_buffer, name);
+		m_buffer += "\"}},\n";
+
+		emittedName = std::move(name);
+	}
+
+	return tid;
+}
\ No newline at end of file
@@ -0,0 +1,601 @@
+#include <aurora/singletons/WriterManager.hpp>
+
+#include <aurora/singletons/TargetManager.hpp>
+#include <aurora/singletons/LoadManager.hpp>
+
+#include "CrashLock.hpp"
+
+#include <mutex>
+#include <condition_variable>
+#include <print>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cerrno>
+#include <csignal>
+#include <exception>
+
+#if !defined(_WIN32)
+	#include <time.h>
+	#include <unistd.h>
+#endif
+
+using namespace aurora;
+
+
+namespace {
+
+thread_local bool t_isWriter = false;
+// number of streamed records open on this thread
+thread_local std::uint32_t t_streams = 0u;
+
+// spilled records are written once this much is buffered
+constexpr std::size_t kSpillBufferSize = 64u * 1024u;
+
+#if !defined(_WIN32)
+	constexpr int kFatalSignals[] = { SIGSEGV, SIGABRT, SIGBUS, SIGFPE, SIGTERM };
+	struct sigaction s_previousActions[std::size(kFatalSignals)]{};
+	std::terminate_handler s_previousTerminate = nullptr;
+	std::atomic_bool s_handlingCrash = false;
+
+	// a lock held by the crashed thread itself is never released, so waiting is bounded
+	template <typename TryLock>
+	bool lockOnCrash(TryLock&& tryLock) noexcept {
+		for (int i = 0; i < 100; ++i) {
+			if (tryLock())
+				return true;
+
+			timespec delay{ 0, 1'000'000 };
+			nanosleep(&delay, nullptr);
+		}
+
+		return false;
+	}
+
+	// async-signal-safe
+	void writeAll(int fd, std::string_view data) noexcept {
+		while (!data.empty()) {
+			auto written = ::write(fd, data.data(), data.size());
+			if (written < 0) {
+				if (errno == EINTR)
+					continue;
+				return;
+			}
+			data.remove_prefix(static_cast<std::size_t>(written));
+		}
+
+		return;
+	}
+
+	// best-effort: records printed to std::cout wait in the buffer of stdout, unless it isn't synced with stdio.
+	// Only glibc exposes that buffer; it's read without the stream's lock, which a handler can't take,
+	// so output another thread is printing meanwhile may be cut or written twice
+	void writeStdioBuffer([[maybe_unused]] std::FILE* file, [[maybe_unused]] int fd) noexcept {
+		#if defined(__GLIBC__)
+			if (file->_IO_write_base != nullptr && file->_IO_write_ptr > file->_IO_write_base) {
+				writeAll(fd, {
+					file->_IO_write_base,
+					static_cast<std::size_t>(file->_IO_write_ptr - file->_IO_write_base)
+				});
+			}
+		#endif
+
+		return;
+	}
+#endif
+
+} // namespace
+
+
+struct WriterManager::State final {
+	// guards the lanes, the batch and the settings
+	CrashLock mutex{};
+	std::condition_variable_any notEmpty{};
+	std::condition_variable_any notFull{};
+	std::condition_variable_any drained{};
+
+	// held while a record or a chunk of a streamed record is written; recursive, as the targets may log while it's held
+	std::recursive_mutex outputMutex{};
+
+	CrashLock spillMutex{};
+	// unbuffered; spilled records are buffered in spillBuffer instead, which the crash flush can write
+	std::FILE* spillFile = nullptr;
+	int spillFd = -1;
+	std::string spillBuffer{};
+
+	void writeSpill() noexcept {
+		if (spillFile && !spillBuffer.empty())
+			std::fwrite(spillBuffer.data(), 1u, spillBuffer.size(), spillFile);
+		spillBuffer.clear();
+
+		return;
+	}
+};
+
+
+WriterManager* WriterManager::get() noexcept {
+	static auto instance = []() {
+		auto ret = new WriterManager();
+		std::atexit([]() {
+			WriterManager::get()->setAsyncEnabled(false);
+			WriterManager::get()->flush();
+		});
+
+		return ret;
+	}();
+
+	return instance;
+}
+
+WriterManager::WriterManager() noexcept
+	: m_state(std::make_unique<State>()) {}
+
+WriterManager::~WriterManager() = default;
+
+
+void WriterManager::setAsyncEnabled(bool on) noexcept {
+	if (on == m_async.load(std::memory_order_relaxed))
+		return;
+
+	if (on) {
+		{
+			std::lock_guard lock(m_state->mutex);
+			m_running = true;
+		}
+		m_writer = std::jthread([this](std::stop_token stop) { this->run(stop); });
+		m_async.store(true, std::memory_order_relaxed);
+		return;
+	}
+
+	m_async.store(false, std::memory_order_relaxed);
+
+	{
+		std::lock_guard lock(m_state->mutex);
+		m_writer.request_stop();
+	}
+	m_state->notEmpty.notify_all();
+	m_writer.join();
+
+	return;
+}
+
+std::size_t WriterManager::getQueueCapacity() const noexcept {
+	std::lock_guard lock(m_state->mutex);
+
+	return m_capacity;
+}
+
+void WriterManager::setQueueCapacity(std::size_t capacity) noexcept {
+	if (capacity == 0u) {
+		log::warn("[AURORA] Can't set queue capacity to 0.");
+		return;
+	}
+
+	{
+		std::lock_guard lock(m_state->mutex);
+		m_capacity = capacity;
+	}
+	m_state->notFull.notify_all();
+
+	return;
+}
+
+WriterManager::BackpressurePolicy WriterManager::getBackpressurePolicy(log::LogLevel logLevel) const noexcept {
+	if (logLevel == log::LogLevel::Error)
+		return BackpressurePolicy::Block;
+
+	std::lock_guard lock(m_state->mutex);
+
+	return m_policies[std::to_underlying(logLevel)];
+}
+
+void WriterManager::setBackpressurePolicy(log::LogLevel logLevel, BackpressurePolicy policy) noexcept {
+	if (logLevel == log::LogLevel::Error) {
+		log::warn("[AURORA] Error records are never dropped; backpressure policy ignored.");
+		return;
+	}
+
+	std::lock_guard lock(m_state->mutex);
+	m_policies[std::to_underlying(logLevel)] = policy;
+
+	return;
+}
+
+bool WriterManager::setOverflowFile(std::string_view pathToAFile) noexcept {
+	bool opened;
+	{
+		std::lock_guard lock(m_state->spillMutex);
+
+		m_state->writeSpill();
+		if (m_state->spillFile)
+			std::fclose(m_state->spillFile);
+
+		m_state->spillFile = std::fopen(std::string(pathToAFile).c_str(), "a");
+		m_state->spillFd = -1;
+		if (m_state->spillFile) {
+			std::setvbuf(m_state->spillFile, nullptr, _IONBF, 0u);
+			#if !defined(_WIN32)
+				m_state->spillFd = fileno(m_state->spillFile);
+			#endif
+		}
+		opened = m_state->spillFile != nullptr;
+	}
+
+	if (!opened) {
+		log::warn(
+			"[AURORA] Failed to set overflow file '{}': {}.",
+			pathToAFile, std::strerror(errno)
+		);
+		return false;
+	}
+
+	log::info("[AURORA] Overflow file '{}' set.", pathToAFile);
+
+	return true;
+}
+
+void WriterManager::flush() noexcept {
+	if (this->getAsyncEnabled()) {
+		std::unique_lock lock(m_state->mutex);
+		m_state->drained.wait(lock, [this]() { return m_errorLane.empty() && m_lane.empty() && !m_writing; });
+	}
+
+	std::lock_guard spillLock(m_state->spillMutex);
+	m_state->writeSpill();
+
+	return;
+}
+
+
+bool WriterManager::setCrashFlushEnabled(bool on) noexcept {
+	#if defined(_WIN32)
+		log::warn("[AURORA] Crash flush is not supported on this platform.");
+		return false;
+	#else
+		if (on == m_crashFlush.exchange(on))
+			return true;
+
+		if (on) {
+			// the handlers reach the targets through function-local statics, which mustn't be initialized in a handler
+			TargetManager::get()->prepareCrashFlush();
+
+			struct sigaction action{};
+			action.sa_handler = &WriterManager::onFatalSignal;
+			sigemptyset(&action.sa_mask);
+
+			for (std::size_t i = 0u; i < std::size(kFatalSignals); ++i) {
+				sigaction(kFatalSignals[i], nullptr, &s_previousActions[i]);
+
+				// ignored signals stay ignored
+				auto const& previous = s_previousActions[i];
+				if (!(previous.sa_flags & SA_SIGINFO) && previous.sa_handler == SIG_IGN)
+					continue;
+
+				sigaction(kFatalSignals[i], &action, nullptr);
+			}
+			s_previousTerminate = std::set_terminate(&WriterManager::onTerminate);
+		} else {
+			for (std::size_t i = 0u; i < std::size(kFatalSignals); ++i)
+				sigaction(kFatalSignals[i], &s_previousActions[i], nullptr);
+			std::set_terminate(s_previousTerminate);
+		}
+
+		return true;
+	#endif
+}
+
+
+void WriterManager::submit(Record&& record) noexcept {
+	// the writer's own records (e.g. drop reports) can't wait for the writer, neither can records of a thread holding the output
+	if (!this->getAsyncEnabled() || t_isWriter || t_streams != 0u) {
+		this->emit(record);
+		return;
+	}
+
+	std::unique_lock lock(m_state->mutex);
+
+	if (!m_running) {
+		lock.unlock();
+		this->emit(record);
+		return;
+	}
+
+	if (record.logLevel == log::LogLevel::Error) {
+		m_errorLane.emplace_back(std::move(record));
+		m_hasErrors.store(true, std::memory_order_relaxed);
+		lock.unlock();
+		m_state->notEmpty.notify_one();
+		return;
+	}
+
+	if (m_lane.size() >= m_capacity) {
+		switch (m_policies[std::to_underlying(record.logLevel)]) {
+			case BackpressurePolicy::Block:
+				m_state->notFull.wait(lock, [this]() { return m_lane.size() < m_capacity || !m_running; });
+
+				if (!m_running) {
+					lock.unlock();
+					this->emit(record);
+					return;
+				}
+				break;
+
+			case BackpressurePolicy::DropNewest:
+				lock.unlock();
+				this->drop(record.logLevel);
+				return;
+
+			case BackpressurePolicy::DropOldest:
+				// only records that may be dropped this way make room, so e.g. blocking warnings aren't lost to debug records
+				while (m_lane.size() >= m_capacity) {
+					auto oldest = std::ranges::find_if(m_lane, [this](Record const& queued) {
+						return m_policies[std::to_underlying(queued.logLevel)] == BackpressurePolicy::DropOldest;
+					});
+
+					if (oldest == m_lane.end()) {
+						lock.unlock();
+						this->drop(record.logLevel);
+						return;
+					}
+
+					this->drop(oldest->logLevel);
+					m_lane.erase(oldest);
+				}
+				break;
+
+			case BackpressurePolicy::Spill:
+				lock.unlock();
+				this->spill(record);
+				return;
+		}
+	}
+
+	m_lane.emplace_back(std::move(record));
+	lock.unlock();
+	m_state->notEmpty.notify_one();
+
+	return;
+}
+
+
+void WriterManager::emit(Record const& record) noexcept {
+	std::lock_guard lock(m_state->outputMutex);
+
+	if (record.toConsole)
+		std::print(log::getLogToStderrEnabled() ? std::cerr : std::cout, "{}", record.console);
+	if (record.toFile)
+		TargetManager::get()->writeRecord(record.logLevel, record.time, record.file, record.console);
+
+	return;
+}
+
+void WriterManager::beginStream() noexcept {
+	// earlier records of this thread have to come first
+	if (t_streams++ == 0u)
+		this->flush();
+
+	return;
+}
+
+void WriterManager::endStream() noexcept {
+	--t_streams;
+
+	return;
+}
+
+void WriterManager::lockOutput() noexcept {
+	m_state->outputMutex.lock();
+
+	return;
+}
+
+void WriterManager::unlockOutput() noexcept {
+	m_state->outputMutex.unlock();
+
+	return;
+}
+
+void WriterManager::spill(Record const& record) noexcept {
+	std::lock_guard lock(m_state->spillMutex);
+
+	if (!m_state->spillFile) {
+		this->drop(record.logLevel);
+		return;
+	}
+
+	m_state->spillBuffer.append(record.file.empty() ? record.console : record.file);
+	if (m_state->spillBuffer.size() >= kSpillBufferSize)
+		m_state->writeSpill();
+
+	return;
+}
+
+void WriterManager::drop(log::LogLevel logLevel) noexcept {
+	m_dropped[std::to_underlying(logLevel)].fetch_add(1u, std::memory_order_relaxed);
+
+	return;
+}
+
+void WriterManager::reportDrops() noexcept {
+	std::uint64_t total = 0u;
+	for (auto const& dropped : m_dropped)
+		total += dropped.load(std::memory_order_relaxed);
+
+	if (total == m_reportedDrops)
+		return;
+
+	log::warn(
+		"[AURORA] Writer fell behind; dropped {} record(s) (debug: {}, info: {}, warn: {} in total).",
+		total - m_reportedDrops,
+		this->getDroppedCount(log::LogLevel::Debug),
+		this->getDroppedCount(log::LogLevel::Info),
+		this->getDroppedCount(log::LogLevel::Warn)
+	);
+	m_reportedDrops = total;
+
+	return;
+}
+
+void WriterManager::run(std::stop_token stop) noexcept {
+	t_isWriter = true;
+
+	// the batch lives in members, so a crash flush can write what's left of it
+	auto takeErrors = [this]() {
+		m_errors.assign(std::make_move_iterator(m_errorLane.begin()), std::make_move_iterator(m_errorLane.end()));
+		m_errorLane.clear();
+		m_errorsDone.store(0u, std::memory_order_relaxed);
+		m_hasErrors.store(false, std::memory_order_relaxed);
+	};
+	auto emitErrors = [this]() {
+		for (auto const& error : m_errors) {
+			this->emit(error);
+			m_errorsDone.fetch_add(1u, std::memory_order_relaxed);
+		}
+	};
+
+	while (true) {
+		{
+			std::unique_lock lock(m_state->mutex);
+
+			m_writing = false;
+			m_state->drained.notify_all();
+
+			// while nothing is logged, the writer closes windows of the load manager, so shedding doesn't outlast the load
+			while (!m_state->notEmpty.wait_for(lock, LoadManager::kWindow, [this, &stop]() {
+				return !m_errorLane.empty() || !m_lane.empty() || stop.stop_requested();
+			})) {
+				lock.unlock();
+				if (auto load = LoadManager::get(); load->isEnabled())
+					load->tick();
+				lock.lock();
+			}
+
+			// queued records are still written after a stop request
+			if (m_errorLane.empty() && m_lane.empty()) {
+				m_running = false;
+				break;
+			}
+
+			takeErrors();
+			m_records.assign(std::make_move_iterator(m_lane.begin()), std::make_move_iterator(m_lane.end()));
+			m_lane.clear();
+			m_recordsDone.store(0u, std::memory_order_relaxed);
+			m_writing = true;
+		}
+		m_state->notFull.notify_all();
+
+		emitErrors();
+
+		for (auto const& record : m_records) {
+			// errors submitted in the meantime jump ahead of the rest of the batch
+			if (m_hasErrors.load(std::memory_order_relaxed)) {
+				{
+					std::lock_guard lock(m_state->mutex);
+					takeErrors();
+				}
+
+				emitErrors();
+			}
+
+			this->emit(record);
+			m_recordsDone.fetch_add(1u, std::memory_order_relaxed);
+		}
+
+		this->reportDrops();
+	}
+
+	m_state->drained.notify_all();
+	m_state->notFull.notify_all();
+
+	return;
+}
+
+
+void WriterManager::flushOnCrash() noexcept {
+	#if !defined(_WIN32)
+		auto targets = TargetManager::get();
+		int console = log::getLogToStderrEnabled() ? STDERR_FILENO : STDOUT_FILENO;
+
+		bool targetsLocked = lockOnCrash([targets]() { return targets->tryLockTargetsOnCrash(); });
+		bool blocksLocked = targetsLocked && lockOnCrash([targets]() { return targets->tryLockBlocksOnCrash(); });
+		bool queueLocked = lockOnCrash([this]() { return m_state->mutex.tryLockOnCrash(); });
+		bool spillLocked = lockOnCrash([this]() { return m_state->spillMutex.tryLockOnCrash(); });
+		bool segmentsLocked = lockOnCrash([targets]() { return targets->tryLockSegmentsOnCrash(); });
+
+		// console output still in stdio's buffers was printed before anything queued
+		writeStdioBuffer(stdout, STDOUT_FILENO);
+		writeStdioBuffer(stderr, STDERR_FILENO);
+
+		// older records first: blocks sealed before the queued records were submitted
+		if (blocksLocked)
+			targets->writeBlocksOnCrash();
+
+		auto emitOnCrash = [targets, targetsLocked, console](Record const& record) {
+			if (record.toConsole)
+				writeAll(console, record.console);
+			if (record.toFile && targetsLocked)
+				targets->writeRecordOnCrash(record.logLevel, record.time, record.file, record.console);
+		};
+
+		if (queueLocked) {
+			for (auto i = m_errorsDone.load(std::memory_order_relaxed); i < m_errors.size(); ++i)
+				emitOnCrash(m_errors[i]);
+			for (auto i = m_recordsDone.load(std::memory_order_relaxed); i < m_records.size(); ++i)
+				emitOnCrash(m_records[i]);
+			for (auto const& record : m_errorLane)
+				emitOnCrash(record);
+			for (auto const& record : m_lane)
+				emitOnCrash(record);
+		}
+
+		if (spillLocked && m_state->spillFd != -1)
+			writeAll(m_state->spillFd, m_state->spillBuffer);
+
+		// segments are written by their threads without going through the queue
+		if (segmentsLocked)
+			targets->writeSegmentsOnCrash();
+
+		// released in case the process survives the signal
+		if (segmentsLocked)
+			targets->unlockSegmentsOnCrash();
+		if (spillLocked)
+			m_state->spillMutex.unlockOnCrash();
+		if (queueLocked)
+			m_state->mutex.unlockOnCrash();
+		if (blocksLocked || targetsLocked)
+			targets->unlockOnCrash(blocksLocked);
+	#endif
+
+	return;
+}
+
+void WriterManager::onFatalSignal(int signal) noexcept {
+	#if !defined(_WIN32)
+		if (!s_handlingCrash.exchange(true))
+			WriterManager::get()->flushOnCrash();
+
+		// the previous disposition (usually the default one) gets the signal once this handler returns
+		for (std::size_t i = 0u; i < std::size(kFatalSignals); ++i) {
+			if (kFatalSignals[i] == signal)
+				sigaction(signal, &s_previousActions[i], nullptr);
+		}
+		raise(signal);
+	#endif
+
+	return;
+}
+
+void WriterManager::onTerminate() noexcept {
+	#if !defined(_WIN32)
+		if (!s_handlingCrash.exchange(true))
+			WriterManager::get()->flushOnCrash();
+
+		if (s_previousTerminate)
+			s_previousTerminate();
+	#endif
+
+	std::abort();
+}
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include "test.hpp"
+
+#include <aurora/singletons/ClockManager.hpp>
+
+#include <chrono>
+#include <thread>
+#include <cstdlib>
+
+using namespace aurora;
+
+
+namespace {
+
+namespace ch = std::chrono;
+
+// converted times may be off by the calibration error plus the time between the two clock reads
+constexpr auto kTolerance = ch::milliseconds(2);
+
+// @return Largest difference between converted fast-clock times and the system clock over @p duration
+ch::nanoseconds maxDeviation(ch::milliseconds duration, bool& monotonic) {
+	auto clocks = ClockManager::get();
+	ch::nanoseconds ret{};
+	ch::system_clock::time_point previous{};
+	monotonic = true;
+
+	for (auto end = ch::steady_clock::now() + duration; ch::steady_clock::now() < end; ) {
+		auto converted = clocks->toSystemTime(clocks->now());
+		auto reference = ch::system_clock::now();
+
+		ret = std::max<ch::nanoseconds>(ret, ch::abs(reference - converted));
+		monotonic &= converted >= previous;
+		previous = converted;
+
+		std::this_thread::sleep_for(ch::microseconds(200));
+	}
+
+	return ret;
+}
+
+void checkSource(ClockManager::ClockSource source) {
+	auto clocks = ClockManager::get();
+	auto interval = clocks->getResyncInterval();
+
+	clocks->setClockSource(source);
+
+	bool monotonic;
+	AURORA_CHECK(maxDeviation(ch::milliseconds(100), monotonic) <= kTolerance);
+	AURORA_CHECK(monotonic);
+
+	// several resyncs happen within the measurement; slewing keeps converted times close and never going backwards
+	clocks->setResyncInterval(ch::milliseconds(20));
+	AURORA_CHECK(maxDeviation(ch::milliseconds(300), monotonic) <= kTolerance);
+	AURORA_CHECK(monotonic);
+
+	clocks->setResyncInterval(interval);
+	clocks->setClockSource(ClockManager::ClockSource::System);
+}
+
+} // namespace
+
+
+AURORA_TEST(clockSteadyMatchesSystemClock) {
+	checkSource(ClockManager::ClockSource::Steady);
+}
+
+AURORA_TEST(clockTSCMatchesSystemClock) {
+	if (!ClockManager::isTSCInvariant())
+		return;
+
+	checkSource(ClockManager::ClockSource::TSC);
+}
\ No newline at end of file
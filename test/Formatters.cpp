@@ -0,0 +1,37 @@
+#include "test.hpp"
+
+#include <aurora/Formatters.hpp>
+
+#include <format>
+#include <string>
+#include <string_view>
+
+using namespace aurora;
+
+
+AURORA_TEST(formatHexdump) {
+	using namespace std::string_view_literals;
+
+	AURORA_CHECK(std::format("{}", hexdump("Hello\n\x00\x01"sv)) == "00000000  48 65 6c 6c 6f 0a 00 01                           |Hello...|");
+
+	// 16 bytes per line, split into two groups of 8
+	AURORA_CHECK(std::format("{}", hexdump("ABCDEFGHIJKLMNOPQ"sv)) ==
+		"00000000  41 42 43 44 45 46 47 48  49 4a 4b 4c 4d 4e 4f 50  |ABCDEFGHIJKLMNOP|\n"
+		"00000010  51                                                |Q|"
+	);
+
+	AURORA_CHECK(std::format("{}", hexdump(std::string_view())).empty());
+}
+
+AURORA_TEST(formatTruncated) {
+	AURORA_CHECK(std::format("{}", truncated("Hello, world", 5u)) == "Hello... [+7 bytes]");
+	AURORA_CHECK(std::format("{}", truncated("Hello", 5u)) == "Hello");
+	AURORA_CHECK(std::format("{}", truncated("Hello", 0u)) == "... [+5 bytes]");
+}
+
+AURORA_TEST(formatEscaped) {
+	using namespace std::string_view_literals;
+
+	AURORA_CHECK(std::format("{}", escaped("GET /\r\n\t\\\x00\x7f\xff"sv)) == "GET /\\r\\n\\t\\\\\\x00\\x7f\\xff");
+	AURORA_CHECK(std::format("{}", escaped("plain text"sv)) == "plain text");
+}
\ No newline at end of file
@@ -0,0 +1,202 @@
+#include "test.hpp"
+
+#include <aurora/log.hpp>
+#include <aurora/singletons/LoadManager.hpp>
+#include <aurora/singletons/TargetManager.hpp>
+
+#include <streambuf>
+#include <iostream>
+#include <filesystem>
+#include <string>
+#include <chrono>
+
+using namespace aurora;
+
+
+std::pair<bool, bool> test::Access::admit(log::LogLevel logLevel, bool toConsole, bool toFile) noexcept {
+	return LoadManager::get()->admit(logLevel, toConsole, toFile);
+}
+
+void test::Access::addBytes(std::size_t consoleBytes, std::size_t fileBytes) noexcept {
+	LoadManager::get()->addBytes(consoleBytes, fileBytes);
+
+	return;
+}
+
+void test::Access::closeWindow(std::chrono::nanoseconds elapsed) noexcept {
+	LoadManager::get()->closeWindow(elapsed.count());
+
+	return;
+}
+
+
+namespace {
+
+using Sink = LoadManager::Sink;
+using Level = log::LogLevel;
+
+// console buffer that keeps the notices of the load manager
+class Capture final : public std::streambuf {
+public:
+	Capture()
+		: m_stream(log::getLogToStderrEnabled() ? std::cerr : std::cout)
+		, m_previous(m_stream.rdbuf(this)) {}
+	~Capture() override { m_stream.rdbuf(m_previous); }
+
+	// @return Output since the last call
+	[[nodiscard]] std::string take() { return std::exchange(m_text, {}); }
+
+protected:
+	std::streamsize xsputn(char const* data, std::streamsize size) override {
+		m_text.append(data, static_cast<std::size_t>(size));
+
+		return size;
+	}
+
+	int_type overflow(int_type c) override {
+		if (!traits_type::eq_int_type(c, traits_type::eof()))
+			m_text.push_back(traits_type::to_char_type(c));
+
+		return traits_type::not_eof(c);
+	}
+
+private:
+	std::ostream& m_stream;
+	std::streambuf* m_previous;
+	std::string m_text{};
+};
+
+// a window of console records per level (debug, info, warn, error), closed after a second
+void window(std::size_t debug, std::size_t info, std::size_t warn = 0u, std::size_t error = 0u) {
+	std::size_t counts[] = { debug, info, warn, error };
+
+	for (std::size_t level = 0u; level < std::size(counts); ++level) {
+		for (std::size_t i = 0u; i < counts[level]; ++i)
+			[[maybe_unused]] auto admitted = test::Access::admit(static_cast<Level>(level), true, false);
+	}
+	test::Access::closeWindow(LoadManager::kWindow);
+}
+
+} // namespace
+
+
+AURORA_TEST(loadEscalatesUpToWarn) {
+	auto load = LoadManager::get();
+	Capture capture;
+
+	load->setBudget(Sink::Console, { .recordsPerSecond = 100u });
+
+	window(200u, 50u, 10u);
+	AURORA_CHECK(load->getShedLevel(Sink::Console) == Level::Info);
+	AURORA_CHECK(capture.take().contains("Console output over budget"));
+
+	window(200u, 150u, 10u);
+	AURORA_CHECK(load->getShedLevel(Sink::Console) == Level::Warn);
+
+	// errors are never shed, and warnings only count against the budget
+	window(0u, 0u, 500u, 500u);
+	AURORA_CHECK(load->getShedLevel(Sink::Console) == Level::Warn);
+	AURORA_CHECK(!test::Access::admit(Level::Info, true, false).first);
+	AURORA_CHECK(test::Access::admit(Level::Warn, true, false).first);
+	AURORA_CHECK(test::Access::admit(Level::Error, true, false).first);
+
+	load->setBudget(Sink::Console, {});
+	AURORA_CHECK(load->getShedLevel(Sink::Console) == Level::Debug);
+}
+
+AURORA_TEST(loadLowersWithHysteresis) {
+	auto load = LoadManager::get();
+	Capture capture;
+
+	load->setBudget(Sink::Console, { .recordsPerSecond = 100u });
+	window(300u, 300u, 10u);
+	AURORA_CHECK(load->getShedLevel(Sink::Console) == Level::Warn);
+
+	// within the budget, but not within the restore ratio of it
+	window(0u, 80u);
+	AURORA_CHECK(load->getShedLevel(Sink::Console) == Level::Warn);
+
+	// one level down at a time fits, the next doesn't
+	window(20u, 60u);
+	AURORA_CHECK(load->getShedLevel(Sink::Console) == Level::Info);
+	AURORA_CHECK(capture.take().contains("Console output load dropped"));
+
+	window(10u, 10u);
+	AURORA_CHECK(load->getShedLevel(Sink::Console) == Level::Debug);
+	AURORA_CHECK(capture.take().contains("Console output back within budget; shedding ended."));
+
+	load->setBudget(Sink::Console, {});
+}
+
+AURORA_TEST(loadEndsWithBudget) {
+	auto load = LoadManager::get();
+	Capture capture;
+
+	load->setBudget(Sink::Console, { .recordsPerSecond = 100u });
+	window(200u, 50u);
+	AURORA_CHECK(load->getShedLevel(Sink::Console) == Level::Info);
+
+	// no window has to close first
+	load->setBudget(Sink::Console, {});
+	AURORA_CHECK(load->getShedLevel(Sink::Console) == Level::Debug);
+	AURORA_CHECK(capture.take().contains("Console output budget removed; shedding ended."));
+	AURORA_CHECK(test::Access::admit(Level::Debug, true, false).first);
+}
+
+AURORA_TEST(loadCountsLateWindowAsOne) {
+	auto load = LoadManager::get();
+	Capture capture;
+
+	load->setBudget(Sink::Console, { .recordsPerSecond = 100u });
+
+	// a burst closed by the first record after a quiet period isn't averaged over the whole period
+	for (int i = 0; i < 150; ++i)
+		[[maybe_unused]] auto admitted = test::Access::admit(Level::Debug, true, false);
+	test::Access::closeWindow(std::chrono::seconds(10));
+	AURORA_CHECK(load->getShedLevel(Sink::Console) == Level::Info);
+	AURORA_CHECK(load->getThroughput(Sink::Console).recordsPerSecond == 150.0);
+
+	load->setBudget(Sink::Console, {});
+}
+
+AURORA_TEST(loadShedsBytes) {
+	auto load = LoadManager::get();
+	Capture capture;
+
+	load->setBudget(Sink::Console, { .bytesPerSecond = 10'000u });
+
+	// 100 bytes per record
+	for (int i = 0; i < 200; ++i) {
+		[[maybe_unused]] auto admitted = test::Access::admit(i < 150 ? Level::Debug : Level::Info, true, false);
+		test::Access::addBytes(100u, 0u);
+	}
+	test::Access::closeWindow(LoadManager::kWindow);
+	AURORA_CHECK(load->getShedLevel(Sink::Console) == Level::Info);
+	AURORA_CHECK(load->getThroughput(Sink::Console).bytesPerSecond == 20'000.0);
+
+	load->setBudget(Sink::Console, {});
+}
+
+AURORA_TEST(loadShedsTargetsBelowFileLevel) {
+	namespace fs = std::filesystem;
+
+	auto load = LoadManager::get();
+	auto targets = TargetManager::get();
+	auto path = (fs::temp_directory_path()/"aurora-test-load.log").string();
+	Capture capture;
+
+	// the target takes debug records, though the file logging level doesn't
+	log::setFileLogLevel(Level::Info);
+	AURORA_CHECK(targets->addLogTarget(path, { .logLevel = Level::Debug }));
+	load->setBudget(Sink::File, { .recordsPerSecond = 100u });
+
+	for (int i = 0; i < 200; ++i)
+		[[maybe_unused]] auto admitted = test::Access::admit(i < 150 ? Level::Debug : Level::Info, false, true);
+	test::Access::closeWindow(LoadManager::kWindow);
+	AURORA_CHECK(load->getShedLevel(Sink::File) == Level::Info);
+	AURORA_CHECK(!test::Access::admit(Level::Debug, false, true).second);
+
+	load->setBudget(Sink::File, {});
+	AURORA_CHECK(targets->removeLogTarget(path));
+	fs::remove(path);
+}
\ No newline at end of file
@@ -0,0 +1,159 @@
+#include "test.hpp"
+
+#include <aurora/log.hpp>
+#include <aurora/LogSegment.hpp>
+#include <aurora/singletons/TargetManager.hpp>
+#include <aurora/singletons/ThreadManager.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <thread>
+#include <cstdint>
+
+using namespace aurora;
+
+
+namespace {
+
+namespace fs = std::filesystem;
+
+struct Frame final {
+	std::int64_t time;
+	std::string_view text;
+};
+
+void writeSegment(fs::path const& path, std::initializer_list<Frame> frames, std::size_t cut = 0u) {
+	std::string data(LogSegment::kMagic, sizeof(LogSegment::kMagic));
+
+	for (auto const& frame : frames) {
+		LogSegment::RecordHeader header{};
+		header.time = frame.time;
+		header.size = static_cast<std::uint32_t>(frame.text.size());
+		header.logLevel = log::LogLevel::Info;
+
+		data.append(reinterpret_cast<char const*>(&header), sizeof(header));
+		data.append(frame.text);
+	}
+
+	std::ofstream(path, std::ios::binary).write(data.data(), static_cast<std::streamsize>(data.size() - cut));
+}
+
+std::vector<std::string> readSegment(fs::path const& path) {
+	std::vector<std::string> ret;
+	LogSegment::Reader reader(path.string());
+	LogSegment::Record record;
+
+	while (reader.next(record))
+		ret.emplace_back(record.text);
+
+	return ret;
+}
+
+std::string readFile(fs::path const& path) {
+	std::stringstream ret;
+	ret << std::ifstream(path).rdbuf();
+
+	return ret.str();
+}
+
+} // namespace
+
+
+AURORA_TEST(segmentReaderStopsAtTruncatedRecord) {
+	auto dir = fs::temp_directory_path()/"aurora-test-segment-reader";
+	fs::remove_all(dir);
+	fs::create_directories(dir);
+
+	writeSegment(dir/"whole.seg", { { 1, "first\n" }, { 2, "second\n" } });
+	writeSegment(dir/"cut.seg", { { 1, "first\n" }, { 2, "second\n" } }, 3u);
+	std::ofstream(dir/"other.seg") << "not a segment";
+
+	AURORA_CHECK(readSegment(dir/"whole.seg") == std::vector<std::string>({ "first\n", "second\n" }));
+	AURORA_CHECK(readSegment(dir/"cut.seg") == std::vector<std::string>({ "first\n" }));
+	AURORA_CHECK(!LogSegment::Reader((dir/"other.seg").string()).isValid());
+	AURORA_CHECK(!LogSegment::Reader((dir/"missing.seg").string()).isValid());
+
+	fs::remove_all(dir);
+}
+
+AURORA_TEST(segmentMergeOrdersByTime) {
+	auto dir = fs::temp_directory_path()/"aurora-test-segment-merge";
+	fs::remove_all(dir);
+	fs::create_directories(dir);
+
+	writeSegment(dir/"a.seg", { { 1, "a1" }, { 3, "a3" }, { 5, "a5" } });
+	writeSegment(dir/"b.seg", { { 2, "b2" }, { 3, "b3" }, { 4, "b4" }, { 6, "b6" } });
+	writeSegment(dir/"c.seg", {});
+	std::ofstream(dir/"other.seg") << "not a segment";
+
+	std::vector<std::string> paths{ (dir/"a.seg").string(), (dir/"other.seg").string(), (dir/"b.seg").string(), (dir/"c.seg").string() };
+	std::vector<std::string> merged;
+	auto invalid = LogSegment::merge(paths, [&merged](LogSegment::Record const& record) { merged.emplace_back(record.text); });
+
+	// equal times keep the order of the paths
+	AURORA_CHECK(invalid == 1u);
+	AURORA_CHECK(merged == std::vector<std::string>({ "a1", "b2", "a3", "b3", "b4", "a5", "b6" }));
+
+	fs::remove_all(dir);
+}
+
+AURORA_TEST(segmentWriterTakesNamedThreads) {
+	auto targets = TargetManager::get();
+	auto dir = fs::temp_directory_path()/"aurora-test-segments";
+	fs::remove_all(dir);
+
+	auto log = targets->logToDir(dir.string(), "Segments");
+	AURORA_CHECK(log);
+	if (!log)
+		return;
+	AURORA_CHECK(targets->setThreadSegmentsEnabled(true));
+
+	auto extra = (fs::temp_directory_path()/"aurora-test-segments-extra.log").string();
+	std::jthread([targets, &extra]() {
+		// records of a thread without a name go to the targets
+		log::info("seg-unnamed");
+
+		ThreadManager::get()->addThread("seg-worker");
+		log::info("seg-named-1");
+		log::info("seg-named-2");
+
+		// another target suspends segments, so it misses nothing
+		targets->addLogTarget(extra);
+		log::info("seg-suspended");
+		targets->removeLogTarget(extra);
+		log::info("seg-resumed");
+
+		targets->flushThreadSegment();
+		ThreadManager::get()->removeThread("seg-worker");
+	}).join();
+
+	AURORA_CHECK(targets->setThreadSegmentsEnabled(false));
+	AURORA_CHECK(targets->removeLogTarget(*log));
+
+	std::vector<std::string> segments;
+	for (auto const& file : fs::directory_iterator(dir)) {
+		if (file.path().extension() == LogSegment::kExtension)
+			segments.emplace_back(file.path().string());
+	}
+	AURORA_CHECK(segments.size() == 1u && segments.front().contains("[seg-worker]"));
+	if (segments.size() != 1u)
+		return;
+
+	std::string segment;
+	for (auto const& record : readSegment(segments.front()))
+		segment.append(record);
+	AURORA_CHECK(segment.contains("seg-named-1") && segment.contains("seg-named-2") && segment.contains("seg-resumed"));
+	AURORA_CHECK(!segment.contains("seg-unnamed") && !segment.contains("seg-suspended"));
+
+	auto text = readFile(*log);
+	AURORA_CHECK(text.contains("seg-unnamed") && text.contains("seg-suspended"));
+	AURORA_CHECK(text.contains("Thread segments suspended") && text.contains("Thread segments resumed"));
+	AURORA_CHECK(!text.contains("seg-named-1") && !text.contains("seg-resumed"));
+	AURORA_CHECK(readFile(extra).contains("seg-suspended"));
+
+	fs::remove_all(dir);
+	fs::remove(extra);
+}
\ No newline at end of file
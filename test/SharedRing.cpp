@@ -0,0 +1,216 @@
+#include "test.hpp"
+
+#include <aurora/SharedRing.hpp>
+
+#include <string>
+#include <chrono>
+#include <thread>
+#include <cstdint>
+
+#if !defined(_WIN32)
+	#include <sys/wait.h>
+	#include <unistd.h>
+#endif
+
+using namespace aurora;
+
+
+bool test::Access::reserve(SharedRing& ring) noexcept {
+	std::uint64_t position;
+
+	return ring.reserve(position) != nullptr;
+}
+
+
+namespace {
+
+// unique per process, so concurrent test runs don't share rings
+std::string ringName(std::string_view suffix) {
+	#if defined(_WIN32)
+		return std::string(suffix);
+	#else
+		return std::format("/aurora-test-{}-{}", getpid(), suffix);
+	#endif
+}
+
+[[nodiscard]] bool popped(SharedRing& ring, std::string_view expected) {
+	std::string record;
+
+	return ring.pop(record) && record == expected;
+}
+
+} // namespace
+
+
+#if !defined(_WIN32)
+
+AURORA_TEST(sharedRingPushPop) {
+	auto ring = SharedRing::create(ringName("push-pop"), 4u, 64u);
+	AURORA_CHECK(ring);
+	if (!ring)
+		return;
+
+	auto time = std::chrono::system_clock::now();
+	AURORA_CHECK(ring->push(log::LogLevel::Info, time, "ring-first\n"));
+	AURORA_CHECK(ring->push(log::LogLevel::Error, time, "ring-second\n"));
+
+	std::string record;
+	auto entry = ring->pop(record);
+	AURORA_CHECK(entry && record == "ring-first\n");
+	AURORA_CHECK(entry && entry->logLevel == log::LogLevel::Info && entry->pid == getpid());
+	AURORA_CHECK(entry && std::chrono::abs(entry->time - time) < std::chrono::microseconds(1));
+
+	entry = ring->pop(record);
+	AURORA_CHECK(entry && record == "ring-second\n" && entry->logLevel == log::LogLevel::Error);
+	AURORA_CHECK(!ring->pop(record));
+
+	// records longer than a slot are cut, but stay newline-terminated
+	AURORA_CHECK(ring->push(log::LogLevel::Info, time, std::string(100u, 'x')));
+	AURORA_CHECK(popped(*ring, std::string(63u, 'x').append("\n")));
+}
+
+AURORA_TEST(sharedRingWrapsAround) {
+	auto ring = SharedRing::create(ringName("wrap"), 4u, 64u);
+	AURORA_CHECK(ring);
+	if (!ring)
+		return;
+
+	// every slot is reused several times
+	auto time = std::chrono::system_clock::now();
+	for (int lap = 0; lap < 5; ++lap) {
+		for (int i = 0; i < 3; ++i)
+			AURORA_CHECK(ring->push(log::LogLevel::Info, time, std::format("ring-{}-{}\n", lap, i)));
+		for (int i = 0; i < 3; ++i)
+			AURORA_CHECK(popped(*ring, std::format("ring-{}-{}\n", lap, i)));
+	}
+
+	std::string record;
+	AURORA_CHECK(!ring->pop(record));
+	AURORA_CHECK(ring->getDroppedCount() == 0u);
+}
+
+AURORA_TEST(sharedRingDropsWhenFull) {
+	auto ring = SharedRing::create(ringName("full"), 4u, 64u);
+	AURORA_CHECK(ring);
+	if (!ring)
+		return;
+
+	auto time = std::chrono::system_clock::now();
+	for (int i = 0; i < 4; ++i)
+		AURORA_CHECK(ring->push(log::LogLevel::Info, time, std::format("ring-full-{}\n", i)));
+	AURORA_CHECK(!ring->push(log::LogLevel::Info, time, "ring-full-dropped\n"));
+	AURORA_CHECK(ring->getDroppedCount() == 1u);
+
+	// a popped record frees its slot
+	AURORA_CHECK(popped(*ring, "ring-full-0\n"));
+	AURORA_CHECK(ring->push(log::LogLevel::Info, time, "ring-full-4\n"));
+	for (int i = 1; i < 5; ++i)
+		AURORA_CHECK(popped(*ring, std::format("ring-full-{}\n", i)));
+	AURORA_CHECK(ring->getDroppedCount() == 1u);
+}
+
+AURORA_TEST(sharedRingSkipsStalledSlot) {
+	auto ring = SharedRing::create(ringName("stall"), 4u, 64u);
+	AURORA_CHECK(ring);
+	if (!ring)
+		return;
+
+	auto time = std::chrono::system_clock::now();
+	AURORA_CHECK(ring->push(log::LogLevel::Info, time, "ring-before\n"));
+	AURORA_CHECK(test::Access::reserve(*ring));
+	AURORA_CHECK(ring->push(log::LogLevel::Info, time, "ring-after\n"));
+
+	// the reserved slot holds up the records behind it until it times out
+	std::string record;
+	AURORA_CHECK(popped(*ring, "ring-before\n"));
+	AURORA_CHECK(!ring->pop(record));
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	AURORA_CHECK(!ring->pop(record));
+	AURORA_CHECK(ring->getDroppedCount() == 0u);
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(450));
+	AURORA_CHECK(popped(*ring, "ring-after\n"));
+	AURORA_CHECK(ring->getDroppedCount() == 1u);
+	AURORA_CHECK(!ring->pop(record));
+}
+
+AURORA_TEST(sharedRingRetiresProducers) {
+	auto name = ringName("retire");
+	auto ring = SharedRing::create(name, 4u, 64u);
+	AURORA_CHECK(ring);
+	if (!ring)
+		return;
+
+	auto producer = SharedRing::open(name);
+	AURORA_CHECK(producer);
+	if (!producer)
+		return;
+
+	auto time = std::chrono::system_clock::now();
+	AURORA_CHECK(producer->push(log::LogLevel::Warn, time, "ring-produced\n"));
+	AURORA_CHECK(popped(*ring, "ring-produced\n"));
+
+	// a detached collector retires its ring; the producer moves over to the next one
+	ring.reset();
+	AURORA_CHECK(producer->isRetired());
+	AURORA_CHECK(!producer->push(log::LogLevel::Warn, time, "ring-lost\n"));
+	AURORA_CHECK(!producer->reopen());
+
+	ring = SharedRing::create(name, 8u, 64u);
+	AURORA_CHECK(ring);
+	auto reopened = producer->reopen();
+	AURORA_CHECK(reopened && !reopened->isRetired());
+	if (!ring || !reopened)
+		return;
+
+	AURORA_CHECK(reopened->push(log::LogLevel::Warn, time, "ring-reopened\n"));
+	AURORA_CHECK(popped(*ring, "ring-reopened\n"));
+}
+
+AURORA_TEST(sharedRingTakesOverDeadCollector) {
+	auto name = ringName("takeover");
+	// the child reports through one pipe and exits once the other is closed; a closed pipe also ends any wait on a dead peer
+	int ready[2], done[2];
+	AURORA_CHECK(pipe(ready) == 0 && pipe(done) == 0);
+
+	// a collector that dies without detaching, after a producer pushed a record
+	auto collector = fork();
+	if (collector == 0) {
+		close(ready[0]);
+		close(done[1]);
+
+		auto ring = SharedRing::create(name, 4u, 64u);
+		char pushed = ring && ring->push(log::LogLevel::Info, std::chrono::system_clock::now(), "ring-orphan\n");
+		[[maybe_unused]] auto written = write(ready[1], &pushed, 1);
+		[[maybe_unused]] auto read = ::read(done[0], &pushed, 1);
+		_exit(0);
+	}
+	close(ready[1]);
+	close(done[0]);
+	AURORA_CHECK(collector > 0);
+
+	char pushed = 0;
+	AURORA_CHECK(collector > 0 && read(ready[0], &pushed, 1) == 1 && pushed == 1);
+	close(ready[0]);
+
+	// the ring still has its collector
+	if (pushed == 1)
+		AURORA_CHECK(!SharedRing::create(name, 4u, 64u));
+
+	close(done[1]);
+	if (collector > 0)
+		waitpid(collector, nullptr, 0);
+	if (pushed != 1)
+		return;
+
+	auto ring = SharedRing::create(name, 4u, 64u);
+	AURORA_CHECK(ring);
+	if (!ring)
+		return;
+
+	AURORA_CHECK(popped(*ring, "ring-orphan\n"));
+	std::string record;
+	AURORA_CHECK(!ring->pop(record));
+}
+
+#endif
\ No newline at end of file
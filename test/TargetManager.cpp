@@ -0,0 +1,147 @@
+#include "test.hpp"
+
+#include <aurora/log.hpp>
+#include <aurora/singletons/TargetManager.hpp>
+#include <aurora/singletons/WriterManager.hpp>
+#include <aurora/LogBlock.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <string>
+#include <chrono>
+#include <thread>
+
+using namespace aurora;
+
+
+namespace {
+
+namespace fs = std::filesystem;
+
+std::string readFile(fs::path const& path) {
+	std::stringstream ret;
+	ret << std::ifstream(path).rdbuf();
+
+	return ret.str();
+}
+
+// @return Records of all intact blocks of a compressed target, up to the first damaged one
+std::string readBlocks(fs::path const& path) {
+	std::ifstream file(path, std::ios::binary);
+	std::string ret, payload, records;
+
+	while (auto header = LogBlock::readHeader(file)) {
+		payload.resize(header->storedSize);
+		if (!file.read(payload.data(), static_cast<std::streamsize>(payload.size())) || !LogBlock::decode(*header, payload, records))
+			break;
+
+		ret.append(records);
+	}
+
+	return ret;
+}
+
+} // namespace
+
+
+AURORA_TEST(targetLevelsOverrideFileLevel) {
+	auto targets = TargetManager::get();
+	auto fileLogLevel = log::getFileLogLevel();
+
+	auto debugPath = fs::temp_directory_path()/"aurora-test-debug.log";
+	auto warnPath = fs::temp_directory_path()/"aurora-test-warn.log";
+	auto defaultPath = fs::temp_directory_path()/"aurora-test-default.log";
+	for (auto const& path : { debugPath, warnPath, defaultPath })
+		fs::remove(path);
+
+	log::setFileLogLevel(log::LogLevel::Info);
+	AURORA_CHECK(targets->addLogTarget(debugPath.string(), { .logLevel = log::LogLevel::Debug }));
+	AURORA_CHECK(targets->addLogTarget(warnPath.string(), { .logLevel = log::LogLevel::Warn }));
+	AURORA_CHECK(targets->addLogTarget(defaultPath.string()));
+
+	log::debug("tm-debug");
+	log::info("tm-info");
+	log::warn("tm-warn");
+	log::error("tm-error");
+	WriterManager::get()->flush();
+
+	// a target without a level of its own follows the file logging level
+	log::setFileLogLevel(log::LogLevel::Error);
+	log::warn("tm-late-warn");
+	WriterManager::get()->flush();
+
+	AURORA_CHECK(targets->removeLogTarget(debugPath.string()));
+	AURORA_CHECK(targets->removeLogTarget(warnPath.string()));
+	AURORA_CHECK(targets->removeLogTarget(defaultPath.string()));
+	log::setFileLogLevel(fileLogLevel);
+
+	auto debug = readFile(debugPath);
+	AURORA_CHECK(debug.contains("tm-debug"));
+	AURORA_CHECK(debug.contains("tm-info"));
+	AURORA_CHECK(debug.contains("tm-warn"));
+	AURORA_CHECK(debug.contains("tm-error"));
+	AURORA_CHECK(debug.contains("tm-late-warn"));
+
+	auto warn = readFile(warnPath);
+	AURORA_CHECK(!warn.contains("tm-debug"));
+	AURORA_CHECK(!warn.contains("tm-info"));
+	AURORA_CHECK(warn.contains("tm-warn"));
+	AURORA_CHECK(warn.contains("tm-error"));
+	AURORA_CHECK(warn.contains("tm-late-warn"));
+
+	auto followed = readFile(defaultPath);
+	AURORA_CHECK(!followed.contains("tm-debug"));
+	AURORA_CHECK(followed.contains("tm-info"));
+	AURORA_CHECK(followed.contains("tm-error"));
+	AURORA_CHECK(!followed.contains("tm-late-warn"));
+
+	for (auto const& path : { debugPath, warnPath, defaultPath })
+		fs::remove(path);
+}
+
+AURORA_TEST(targetCompressedBlocksKeepOrder) {
+	auto targets = TargetManager::get();
+	auto blockSize = targets->getBlockSize();
+	auto logLevel = log::getLogLevel();
+
+	auto path = fs::temp_directory_path()/"aurora-test-blocks.log";
+	fs::remove(path);
+
+	// many small blocks, so the compressor writes batches while records keep coming
+	targets->setBlockSize(1u);
+	AURORA_CHECK(targets->addLogTarget(path.string(), { .logLevel = log::LogLevel::Debug, .compressed = true }));
+
+	constexpr int kRecords = 2000;
+	log::setLogLevel(log::LogLevel::Warn);
+	for (int i = 0; i < kRecords; ++i)
+		log::debug("tm-block-{:04}", i);
+	WriterManager::get()->flush();
+	log::setLogLevel(logLevel);
+
+	AURORA_CHECK(targets->removeLogTarget(path.string()));
+	targets->setBlockSize(blockSize);
+
+	// blocks are written in the background
+	auto last = std::format("tm-block-{:04}", kRecords - 1);
+	std::string records;
+	for (auto end = std::chrono::steady_clock::now() + std::chrono::seconds(5); std::chrono::steady_clock::now() < end; ) {
+		records = readBlocks(path);
+		if (records.contains(last))
+			break;
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+
+	std::size_t previous = 0u;
+	for (int i = 0; i < kRecords; ++i) {
+		auto position = records.find(std::format("tm-block-{:04}", i), previous);
+		AURORA_CHECK(position != std::string::npos);
+		if (position == std::string::npos)
+			break;
+
+		previous = position;
+	}
+
+	fs::remove(path);
+}
\ No newline at end of file
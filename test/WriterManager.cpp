@@ -0,0 +1,327 @@
+#include "test.hpp"
+
+#include <aurora/log.hpp>
+#include <aurora/singletons/WriterManager.hpp>
+
+#include <streambuf>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <string>
+#include <utility>
+#include <chrono>
+
+using namespace aurora;
+
+
+namespace {
+
+using Policy = WriterManager::BackpressurePolicy;
+
+// console buffer that holds the writer in its first write until opened
+class Gate final : public std::streambuf {
+public:
+	explicit Gate(std::ostream& stream)
+		: m_stream(stream)
+		, m_previous(stream.rdbuf(this)) {}
+	~Gate() override {
+		this->open();
+		m_stream.rdbuf(m_previous);
+	}
+
+	void waitEntered() {
+		std::unique_lock lock(m_mutex);
+		m_changed.wait(lock, [this]() { return m_entered; });
+	}
+
+	void open() {
+		{
+			std::lock_guard lock(m_mutex);
+			m_open = true;
+		}
+		m_changed.notify_all();
+	}
+
+	[[nodiscard]] bool contains(std::string_view text) {
+		std::lock_guard lock(m_mutex);
+
+		return m_text.contains(text);
+	}
+
+	[[nodiscard]] std::size_t find(std::string_view text) {
+		std::lock_guard lock(m_mutex);
+
+		return m_text.find(text);
+	}
+
+protected:
+	std::streamsize xsputn(char const* data, std::streamsize size) override {
+		std::unique_lock lock(m_mutex);
+
+		m_entered = true;
+		m_changed.notify_all();
+		m_changed.wait(lock, [this]() { return m_open; });
+
+		m_text.append(data, static_cast<std::size_t>(size));
+
+		return size;
+	}
+
+	int_type overflow(int_type c) override {
+		if (!traits_type::eq_int_type(c, traits_type::eof())) {
+			char ch = traits_type::to_char_type(c);
+			this->xsputn(&ch, 1);
+		}
+
+		return traits_type::not_eof(c);
+	}
+
+private:
+	std::ostream& m_stream;
+	std::streambuf* m_previous;
+
+	std::mutex m_mutex{};
+	std::condition_variable m_changed{};
+	bool m_entered = false;
+	bool m_open = false;
+	std::string m_text{};
+};
+
+// an async writer stuck on a record, with a lane of 2 records to fill
+class StalledWriter final {
+public:
+	StalledWriter()
+		: m_gate(log::getLogToStderrEnabled() ? std::cerr : std::cout) {
+		auto writer = WriterManager::get();
+
+		m_capacity = writer->getQueueCapacity();
+		for (auto level : { log::LogLevel::Debug, log::LogLevel::Info, log::LogLevel::Warn })
+			m_policies[std::to_underlying(level)] = writer->getBackpressurePolicy(level);
+
+		writer->setQueueCapacity(2u);
+		writer->setAsyncEnabled(true);
+
+		// the writer takes this one off the lane and waits in the gate
+		log::info("wm-stall");
+		m_gate.waitEntered();
+	}
+	~StalledWriter() {
+		auto writer = WriterManager::get();
+
+		this->open();
+		writer->setAsyncEnabled(false);
+
+		writer->setQueueCapacity(m_capacity);
+		for (auto level : { log::LogLevel::Debug, log::LogLevel::Info, log::LogLevel::Warn })
+			writer->setBackpressurePolicy(level, m_policies[std::to_underlying(level)]);
+	}
+
+	// lets the writer go and waits until everything queued is written
+	void open() {
+		m_gate.open();
+		WriterManager::get()->flush();
+	}
+
+	[[nodiscard]] bool wrote(std::string_view text) { return m_gate.contains(text); }
+	// @return Position of @p text in the console output or `std::string::npos`
+	[[nodiscard]] std::size_t position(std::string_view text) { return m_gate.find(text); }
+
+private:
+	Gate m_gate;
+	std::size_t m_capacity;
+	Policy m_policies[3]{};
+};
+
+} // namespace
+
+
+AURORA_TEST(writerDropNewestDropsIncoming) {
+	auto writer = WriterManager::get();
+	auto dropped = writer->getDroppedCount(log::LogLevel::Info);
+
+	StalledWriter stalled;
+	writer->setBackpressurePolicy(log::LogLevel::Info, Policy::DropNewest);
+
+	log::info("wm-newest-1");
+	log::info("wm-newest-2");
+	log::info("wm-newest-3");
+	AURORA_CHECK(writer->getDroppedCount(log::LogLevel::Info) == dropped + 1u);
+
+	stalled.open();
+	AURORA_CHECK(stalled.wrote("wm-newest-1"));
+	AURORA_CHECK(stalled.wrote("wm-newest-2"));
+	AURORA_CHECK(!stalled.wrote("wm-newest-3"));
+}
+
+AURORA_TEST(writerDropOldestDropsQueued) {
+	auto writer = WriterManager::get();
+	auto dropped = writer->getDroppedCount(log::LogLevel::Info);
+
+	StalledWriter stalled;
+	writer->setBackpressurePolicy(log::LogLevel::Info, Policy::DropOldest);
+
+	log::info("wm-oldest-1");
+	log::info("wm-oldest-2");
+	log::info("wm-oldest-3");
+	AURORA_CHECK(writer->getDroppedCount(log::LogLevel::Info) == dropped + 1u);
+
+	stalled.open();
+	AURORA_CHECK(!stalled.wrote("wm-oldest-1"));
+	AURORA_CHECK(stalled.wrote("wm-oldest-2"));
+	AURORA_CHECK(stalled.wrote("wm-oldest-3"));
+}
+
+AURORA_TEST(writerDropOldestKeepsOtherPolicies) {
+	auto writer = WriterManager::get();
+	auto droppedInfo = writer->getDroppedCount(log::LogLevel::Info);
+	auto droppedWarn = writer->getDroppedCount(log::LogLevel::Warn);
+
+	{
+		StalledWriter stalled;
+		writer->setBackpressurePolicy(log::LogLevel::Warn, Policy::Block);
+		writer->setBackpressurePolicy(log::LogLevel::Info, Policy::DropOldest);
+
+		// the queued warning is older, but only the info record may be evicted
+		log::warn("wm-mixed-warn");
+		log::info("wm-mixed-info-1");
+		log::info("wm-mixed-info-2");
+
+		stalled.open();
+		AURORA_CHECK(stalled.wrote("wm-mixed-warn"));
+		AURORA_CHECK(!stalled.wrote("wm-mixed-info-1"));
+		AURORA_CHECK(stalled.wrote("wm-mixed-info-2"));
+	}
+
+	{
+		StalledWriter stalled;
+		writer->setBackpressurePolicy(log::LogLevel::Warn, Policy::Block);
+		writer->setBackpressurePolicy(log::LogLevel::Info, Policy::DropOldest);
+
+		// nothing queued may be evicted, so the incoming record goes
+		log::warn("wm-blocked-warn-1");
+		log::warn("wm-blocked-warn-2");
+		log::info("wm-blocked-info");
+
+		stalled.open();
+		AURORA_CHECK(stalled.wrote("wm-blocked-warn-1"));
+		AURORA_CHECK(stalled.wrote("wm-blocked-warn-2"));
+		AURORA_CHECK(!stalled.wrote("wm-blocked-info"));
+	}
+
+	AURORA_CHECK(writer->getDroppedCount(log::LogLevel::Info) == droppedInfo + 2u);
+	AURORA_CHECK(writer->getDroppedCount(log::LogLevel::Warn) == droppedWarn);
+}
+
+AURORA_TEST(writerNeverDropsErrors) {
+	auto writer = WriterManager::get();
+	static auto const fatal = log::registerLogLevel({
+		.logLevel = log::LogLevel::Error,
+		.logLevelName = "FATAL",
+		.headTag = log::LogLevel::Error,
+		.bodyTag = log::LogLevel::Error
+	});
+
+	for (auto policy : { Policy::DropNewest, Policy::DropOldest }) {
+		auto dropped = writer->getDroppedCount(log::LogLevel::Info);
+
+		StalledWriter stalled;
+		writer->setBackpressurePolicy(log::LogLevel::Info, policy);
+
+		// the lane is full, yet errors of either kind still get through
+		log::info("wm-errors-info-1");
+		log::info("wm-errors-info-2");
+		log::error("wm-errors-error-{}", std::to_underlying(policy));
+		log::custom(fatal, "wm-errors-fatal-{}", std::to_underlying(policy));
+		log::info("wm-errors-info-3");
+		AURORA_CHECK(writer->getDroppedCount(log::LogLevel::Info) == dropped + 1u);
+		AURORA_CHECK(writer->getDroppedCount(log::LogLevel::Error) == 0u);
+
+		stalled.open();
+		AURORA_CHECK(stalled.wrote(std::format("wm-errors-error-{}", std::to_underlying(policy))));
+		AURORA_CHECK(stalled.wrote(std::format("wm-errors-fatal-{}", std::to_underlying(policy))));
+	}
+}
+
+AURORA_TEST(writerWritesErrorsFirst) {
+	auto writer = WriterManager::get();
+
+	StalledWriter stalled;
+	writer->setBackpressurePolicy(log::LogLevel::Info, Policy::DropNewest);
+
+	log::info("wm-first-info-1");
+	log::info("wm-first-info-2");
+	log::error("wm-first-error");
+
+	// the error jumps ahead of the records queued before it
+	stalled.open();
+	auto error = stalled.position("wm-first-error");
+	AURORA_CHECK(error != std::string::npos);
+	AURORA_CHECK(error < stalled.position("wm-first-info-1"));
+	AURORA_CHECK(stalled.position("wm-first-info-1") < stalled.position("wm-first-info-2"));
+	AURORA_CHECK(stalled.position("wm-first-info-2") != std::string::npos);
+}
+
+AURORA_TEST(writerBlockWaitsForWriter) {
+	auto writer = WriterManager::get();
+
+	StalledWriter stalled;
+	writer->setBackpressurePolicy(log::LogLevel::Info, Policy::Block);
+
+	log::info("wm-block-1");
+	log::info("wm-block-2");
+
+	std::atomic_bool logged = false;
+	std::jthread logger([&logged]() {
+		log::info("wm-block-3");
+		logged = true;
+	});
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	AURORA_CHECK(!logged);
+
+	stalled.open();
+	logger.join();
+	writer->flush();
+	AURORA_CHECK(logged);
+	AURORA_CHECK(stalled.wrote("wm-block-1"));
+	AURORA_CHECK(stalled.wrote("wm-block-2"));
+	AURORA_CHECK(stalled.wrote("wm-block-3"));
+}
+
+AURORA_TEST(writerSpillWritesConsoleOnlyRecords) {
+	namespace fs = std::filesystem;
+
+	auto writer = WriterManager::get();
+	auto path = fs::temp_directory_path()/"aurora-test-overflow.log";
+	fs::remove(path);
+
+	// set before stalling, as it logs itself
+	AURORA_CHECK(writer->setOverflowFile(path.string()));
+
+	{
+		StalledWriter stalled;
+		writer->setBackpressurePolicy(log::LogLevel::Info, Policy::Spill);
+
+		// there are no targets, so the records only have console output
+		log::info("wm-spill-1");
+		log::info("wm-spill-2");
+		log::info("wm-spill-3");
+
+		stalled.open();
+		AURORA_CHECK(stalled.wrote("wm-spill-1"));
+		AURORA_CHECK(stalled.wrote("wm-spill-2"));
+		AURORA_CHECK(!stalled.wrote("wm-spill-3"));
+	}
+
+	std::stringstream spilled;
+	spilled << std::ifstream(path).rdbuf();
+	AURORA_CHECK(spilled.str().contains("wm-spill-3"));
+	AURORA_CHECK(!spilled.str().contains("wm-spill-1"));
+
+	fs::remove(path);
+}
\ No newline at end of file
@@ -0,0 +1,131 @@
+#include "test.hpp"
+
+#include <aurora/log.hpp>
+#include <aurora/Formatters.hpp>
+
+#include <streambuf>
+#include <iostream>
+#include <format>
+#include <string>
+#include <vector>
+#include <cstddef>
+
+using namespace aurora;
+
+
+namespace {
+
+// streamed records are written in chunks of this size (plus the header); see src/log.cpp
+constexpr std::size_t kChunkSize = 16u * 1024u;
+
+// console buffer that keeps every write apart
+class Capture final : public std::streambuf {
+public:
+	Capture()
+		: m_stream(log::getLogToStderrEnabled() ? std::cerr : std::cout)
+		, m_previous(m_stream.rdbuf(this)) {}
+	~Capture() override { m_stream.rdbuf(m_previous); }
+
+	[[nodiscard]] std::vector<std::string> const& writes() const noexcept { return m_writes; }
+	[[nodiscard]] std::string text() const {
+		std::string ret;
+		for (auto const& write : m_writes)
+			ret.append(write);
+
+		return ret;
+	}
+
+protected:
+	std::streamsize xsputn(char const* data, std::streamsize size) override {
+		m_writes.emplace_back(data, static_cast<std::size_t>(size));
+
+		return size;
+	}
+
+	int_type overflow(int_type c) override {
+		if (!traits_type::eq_int_type(c, traits_type::eof()))
+			m_writes.emplace_back(1u, traits_type::to_char_type(c));
+
+		return traits_type::not_eof(c);
+	}
+
+private:
+	std::ostream& m_stream;
+	std::streambuf* m_previous;
+	std::vector<std::string> m_writes{};
+};
+
+// a payload whose hex dump spans many chunks
+std::string blob(std::size_t size) {
+	std::string ret(size, '\0');
+	for (std::size_t i = 0u; i < size; ++i)
+		ret[i] = static_cast<char>(i * 7u);
+
+	return ret;
+}
+
+} // namespace
+
+
+AURORA_TEST(streamWritesChunksAtLineBreaks) {
+	auto payload = blob(64u * 1024u);
+	auto expected = std::format("{}", hexdump(payload));
+
+	Capture capture;
+	log::stream(log::LogLevel::Info).write("payload:\n").format("{}", hexdump(payload)).end();
+
+	// the body is never buffered as a whole, and chunks other than the last end at line breaks
+	auto const& writes = capture.writes();
+	AURORA_CHECK(writes.size() > 1u);
+	for (std::size_t i = 0u; i < writes.size(); ++i) {
+		AURORA_CHECK(writes[i].size() <= kChunkSize + 256u);
+		if (i + 1u < writes.size())
+			AURORA_CHECK(writes[i].ends_with('\n'));
+	}
+
+	auto text = capture.text();
+	AURORA_CHECK(text.contains("payload:\n" + expected));
+	AURORA_CHECK(!text.contains("bytes]"));
+}
+
+AURORA_TEST(streamCutsLinesLongerThanAChunk) {
+	Capture capture;
+	log::stream(log::LogLevel::Info).write(std::string(40u * 1024u, 'x')).end();
+
+	// without line breaks, chunks are written whole
+	AURORA_CHECK(capture.writes().size() >= 3u);
+	for (auto const& write : capture.writes())
+		AURORA_CHECK(write.size() <= kChunkSize + 256u);
+	AURORA_CHECK(capture.text().contains(std::string(40u * 1024u, 'x')));
+}
+
+AURORA_TEST(streamCapsBody) {
+	auto payload = blob(500u * 1024u);
+	auto dump = std::format("{}", hexdump(payload));
+
+	Capture capture;
+	log::stream(log::LogLevel::Info, 1000u).format("{}", hexdump(payload)).end();
+
+	// formatting past the cap is only counted, so a single small chunk is written
+	auto text = capture.text();
+	AURORA_CHECK(capture.writes().size() == 1u);
+	AURORA_CHECK(text.contains(std::format("{}... [+{} bytes]", dump.substr(0u, 1000u), dump.size() - 1000u)));
+	AURORA_CHECK(!text.contains(dump.substr(0u, 1001u)));
+}
+
+AURORA_TEST(streamCapsAcrossCalls) {
+	Capture capture;
+	log::stream(log::LogLevel::Info, 10u)
+		.write("0123456")
+		.format("{}{}", 789, "abc")
+		.write("defg")
+		.end();
+
+	// the cap cuts inside the second call; the rest of it and the third call are counted
+	AURORA_CHECK(capture.text().contains("0123456789... [+7 bytes]"));
+
+	Capture exact;
+	log::stream(log::LogLevel::Info, 10u).write("0123456789").end();
+	AURORA_CHECK(exact.text().contains("0123456789"));
+	AURORA_CHECK(!exact.text().contains("bytes]"));
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+#include "test.hpp"
+
+
+int main() {
+	using namespace aurora::test;
+
+	for (auto const& testCase : cases()) {
+		auto before = failures();
+		testCase.run();
+
+		std::println(stderr, "[{}] {}", failures() == before ? " OK " : "FAIL", testCase.name);
+	}
+
+	std::println(stderr, "{} test(s), {} failed check(s).", cases().size(), failures());
+
+	return failures() == 0 ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <aurora/log.hpp>
+
+#include <print>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+
+
+// A minimal test registry: every `AURORA_TEST` in `test/*.cpp` is run by `test/main.cpp`
+
+#define AURORA_TEST(_name) \
+	static void _name(); \
+	static ::aurora::test::Registrar const _name##Registrar(#_name, &_name); \
+	static void _name()
+
+#define AURORA_CHECK(_condition) \
+	do { \
+		if (!(_condition)) { \
+			std::println(stderr, "{}:{}: check failed: {}", __FILE__, __LINE__, #_condition); \
+			++::aurora::test::failures(); \
+		} \
+	} while (false)
+
+
+namespace aurora {
+	class SharedRing;
+	class LoadManager;
+}
+
+namespace aurora::test {
+
+// reaches into internals the public interface can't drive deterministically; each member is defined by the test using it
+struct Access final {
+	// reserves a slot like a producer that stalls before writing its record
+	static bool reserve(SharedRing& ring) noexcept;
+
+	// windows of the load manager, driven by hand instead of by records and time
+	static std::pair<bool, bool> admit(log::LogLevel logLevel, bool toConsole, bool toFile) noexcept;
+	static void addBytes(std::size_t consoleBytes, std::size_t fileBytes) noexcept;
+	static void closeWindow(std::chrono::nanoseconds elapsed) noexcept;
+};
+
+struct Case final {
+	std::string_view name;
+	void (*run)();
+};
+
+inline std::vector<Case>& cases() noexcept {
+	static std::vector<Case> ret;
+
+	return ret;
+}
+
+inline int& failures() noexcept {
+	static int ret = 0;
+
+	return ret;
+}
+
+struct Registrar final {
+	Registrar(std::string_view name, void (*run)()) noexcept { cases().push_back({ name, run }); }
+};
+
+} // namespace aurora::test
\ No newline at end of file
@@ -0,0 +1,55 @@
+// aurora-merge: merges per-thread segments into a single log ordered by time (@see aurora::LogSegment).
+//
+// Usage: aurora-merge <segment | directory>...
+//   Directories contribute all of their segments; pass a single session's segments (e.g. `"logs/App 2025-12-31 23.59.59 ["*.seg`)
+//   to merge only that session. The merged plain log is written to stdout.
+
+#include <aurora/LogSegment.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <print>
+#include <string>
+#include <vector>
+
+using namespace aurora;
+
+
+int main(int argc, char** argv) {
+	namespace fs = std::filesystem;
+
+	if (argc < 2) {
+		std::println(stderr, "Usage: aurora-merge <segment | directory>...");
+		return 2;
+	}
+
+	std::vector<std::string> paths;
+	for (int i = 1; i < argc; ++i) {
+		std::error_code err;
+		if (!fs::is_directory(argv[i], err)) {
+			paths.emplace_back(argv[i]);
+			continue;
+		}
+
+		// sorted, so records with equal times always come out in the same order
+		std::vector<std::string> segments;
+		for (auto const& file : fs::directory_iterator(argv[i], err)) {
+			if (file.path().extension() == LogSegment::kExtension)
+				segments.emplace_back(file.path().string());
+		}
+		std::ranges::sort(segments);
+		paths.insert(paths.end(), segments.begin(), segments.end());
+	}
+
+	auto invalid = LogSegment::merge(paths, [](LogSegment::Record const& record) {
+		std::fwrite(record.text.data(), 1u, record.text.size(), stdout);
+	});
+
+	if (invalid != 0u) {
+		std::println(stderr, "{} file(s) aren't Aurora segments.", invalid);
+		return 1;
+	}
+
+	return 0;
+}
\ No newline at end of file
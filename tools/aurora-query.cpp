@@ -0,0 +1,284 @@
+// aurora-query: extracts a time window and/or level range of a log file using its sidecar index.
+//
+// Usage: aurora-query <log file> [--from <time>] [--to <time>] [--min-level <level>] [--max-level <level>] [--stats]
+//   <time>  is either Unix time in seconds (e.g. `1767225599.5`) or local time (`2025-12-31 23:59:59`)
+//   <level> is one of `debug`, `info`, `warn`, `error`
+//
+// Only the blocks the index marks as overlapping the window are read, so the output is aligned to index blocks.
+// Within those blocks, records of plain targets are filtered by level line by line.
+// Records written after the last index entry are always considered.
+
+#include <aurora/log.hpp>
+#include <aurora/LogIndex.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <iomanip>
+#include <limits>
+#include <optional>
+#include <print>
+#include <sstream>
+#include <string_view>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace aurora;
+
+
+namespace {
+
+struct Range final {
+	std::uint64_t offset;
+	std::uint64_t size;
+};
+
+std::optional<std::int64_t> parseTime(std::string_view str) noexcept {
+	if (!str.empty() && std::ranges::all_of(str, [](char c) { return (c >= '0' && c <= '9') || c == '.'; })) {
+		double seconds;
+		if (std::from_chars(str.data(), str.data() + str.size(), seconds).ec != std::errc())
+			return std::nullopt;
+
+		return static_cast<std::int64_t>(seconds * 1e9);
+	}
+
+	std::tm localTime{};
+	std::istringstream stream{ std::string(str) };
+	stream >> std::get_time(&localTime, "%Y-%m-%d %H:%M:%S");
+	if (stream.fail())
+		return std::nullopt;
+
+	localTime.tm_isdst = -1;
+	auto tt = std::mktime(&localTime);
+	if (tt == -1)
+		return std::nullopt;
+
+	return static_cast<std::int64_t>(tt) * 1'000'000'000;
+}
+
+std::optional<log::LogLevel> parseLevel(std::string_view str) noexcept {
+	auto equals = [str](std::string_view name) {
+		return std::ranges::equal(str, name, [](char lhs, char rhs) {
+			return (lhs >= 'A' && lhs <= 'Z' ? lhs - 'A' + 'a' : lhs) == rhs;
+		});
+	};
+
+	if (equals("debug"))
+		return log::LogLevel::Debug;
+	if (equals("info"))
+		return log::LogLevel::Info;
+	if (equals("warn"))
+		return log::LogLevel::Warn;
+	if (equals("error"))
+		return log::LogLevel::Error;
+
+	return std::nullopt;
+}
+
+// `<time> | [<thread>] <LEVEL> | ...`; std::nullopt for continuation lines and custom levels
+std::optional<log::LogLevel> lineLevel(std::string_view line) noexcept {
+	auto thread = line.find(" | [");
+	if (thread == std::string_view::npos)
+		return std::nullopt;
+
+	auto name = line.find("] ", thread);
+	if (name == std::string_view::npos)
+		return std::nullopt;
+	name += 2u;
+
+	auto end = line.find(" |", name);
+	if (end == std::string_view::npos)
+		return std::nullopt;
+
+	auto levelName = line.substr(name, end - name);
+	while (levelName.ends_with(' '))
+		levelName.remove_suffix(1u);
+
+	return parseLevel(levelName);
+}
+
+void writeOut(std::string_view str) noexcept {
+	std::fwrite(str.data(), 1u, str.size(), stdout);
+
+	return;
+}
+
+// writes records of @p block within the level range; unknown lines follow the previous record
+void filterLevels(std::string_view block, log::LogLevel minLevel, log::LogLevel maxLevel) noexcept {
+	bool keep = true;
+	std::size_t keptFrom = 0u;
+	std::size_t pos = 0u;
+
+	while (pos < block.size()) {
+		auto end = block.find('\n', pos);
+		end = end == std::string_view::npos ? block.size() : end + 1u;
+
+		if (auto logLevel = lineLevel(block.substr(pos, end - pos))) {
+			bool keepLine = *logLevel >= minLevel && *logLevel <= maxLevel;
+
+			if (keep && !keepLine)
+				writeOut(block.substr(keptFrom, pos - keptFrom));
+			else if (!keep && keepLine)
+				keptFrom = pos;
+
+			keep = keepLine;
+		}
+
+		pos = end;
+	}
+
+	if (keep)
+		writeOut(block.substr(keptFrom));
+
+	return;
+}
+
+int usage() noexcept {
+	std::println(
+		stderr,
+		"Usage: aurora-query <log file> [--from <time>] [--to <time>] "
+		"[--min-level <level>] [--max-level <level>] [--stats]"
+	);
+
+	return 2;
+}
+
+} // namespace
+
+
+int main(int argc, char** argv) {
+	namespace ch = std::chrono;
+
+	if (argc < 2)
+		return usage();
+
+	std::string_view path = argv[1];
+	std::int64_t from = std::numeric_limits<std::int64_t>::min();
+	std::int64_t to = std::numeric_limits<std::int64_t>::max();
+	auto minLevel = log::LogLevel::Debug;
+	auto maxLevel = log::LogLevel::Error;
+	bool stats = false;
+
+	for (int i = 2; i < argc; ++i) {
+		std::string_view arg = argv[i];
+
+		if (arg == "--stats") {
+			stats = true;
+			continue;
+		}
+		if (i + 1 >= argc)
+			return usage();
+
+		std::string_view value = argv[++i];
+		if (arg == "--from" || arg == "--to") {
+			auto time = parseTime(value);
+			if (!time) {
+				std::println(stderr, "Invalid time '{}'.", value);
+				return 2;
+			}
+
+			(arg == "--from" ? from : to) = *time;
+		} else if (arg == "--min-level" || arg == "--max-level") {
+			auto logLevel = parseLevel(value);
+			if (!logLevel) {
+				std::println(stderr, "Invalid level '{}'.", value);
+				return 2;
+			}
+
+			(arg == "--min-level" ? minLevel : maxLevel) = *logLevel;
+		} else {
+			return usage();
+		}
+	}
+
+	auto startTime = ch::steady_clock::now();
+
+	int fd = ::open(std::string(path).c_str(), O_RDONLY);
+	struct stat st;
+	if (fd == -1 || fstat(fd, &st) == -1) {
+		std::println(stderr, "Failed to open '{}'.", path);
+		return 1;
+	}
+
+	auto fileSize = static_cast<std::uint64_t>(st.st_size);
+	if (fileSize == 0u)
+		return 0;
+
+	auto memory = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (memory == MAP_FAILED) {
+		std::println(stderr, "Failed to map '{}'.", path);
+		return 1;
+	}
+	std::string_view file(static_cast<char const*>(memory), fileSize);
+
+	auto entries = LogIndex::read(LogIndex::pathFor(path));
+	if (entries.empty())
+		std::println(stderr, "No index for '{}'; reading the whole file.", path);
+
+	std::uint8_t levelMask = 0u;
+	for (auto i = std::to_underlying(minLevel); i <= std::to_underlying(maxLevel); ++i)
+		levelMask |= 1u << i;
+
+	std::vector<Range> ranges;
+	std::uint64_t indexedEnd = 0u;
+	std::int64_t lastTime = std::numeric_limits<std::int64_t>::min();
+
+	for (auto const& entry : entries) {
+		indexedEnd = std::max(indexedEnd, entry.offset + entry.size);
+		lastTime = std::max(lastTime, entry.lastTime);
+
+		if (entry.lastTime < from || entry.firstTime > to || !(entry.levelMask & levelMask))
+			continue;
+		if (entry.offset + entry.size > fileSize)
+			continue;
+
+		// adjacent blocks are merged, so they are written in one go
+		if (!ranges.empty() && ranges.back().offset + ranges.back().size == entry.offset)
+			ranges.back().size += entry.size;
+		else
+			ranges.push_back({ entry.offset, entry.size });
+	}
+	if (indexedEnd < fileSize && to >= lastTime)
+		ranges.push_back({ indexedEnd, fileSize - indexedEnd });
+
+	// tell the kernel which parts are about to be read
+	for (auto const& range : ranges) {
+		auto pageSize = static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE));
+		auto begin = range.offset & ~(pageSize - 1u);
+		madvise(static_cast<char*>(memory) + begin, range.offset + range.size - begin, MADV_WILLNEED);
+	}
+
+	bool filterLines = minLevel != log::LogLevel::Debug || maxLevel != log::LogLevel::Error;
+	std::uint64_t bytesRead = 0u;
+
+	for (auto const& range : ranges) {
+		auto block = file.substr(range.offset, range.size);
+		bytesRead += block.size();
+
+		if (filterLines)
+			filterLevels(block, minLevel, maxLevel);
+		else
+			writeOut(block);
+	}
+	std::fflush(stdout);
+
+	if (stats) {
+		std::println(
+			stderr,
+			"{} index entries, {} range(s), read {} of {} bytes in {:.3f} ms.",
+			entries.size(), ranges.size(), bytesRead, fileSize,
+			ch::duration<double, std::milli>(ch::steady_clock::now() - startTime).count()
+		);
+	}
+
+	munmap(memory, fileSize);
+	close(fd);
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,142 @@
+// aurora-unpack: decodes a compressed log file (@see aurora::LogBlock).
+//
+// Usage: aurora-unpack <log file | -> [--list | --block <n>]
+//   (default)    writes all records to stdout, block by block (`-` reads stdin, e.g. `tail -c +1 -f log.alz | aurora-unpack -`)
+//   --list       lists the blocks: offset, record count, time range, sizes and codec
+//   --block <n>  writes the records of the n-th block (0-based), skipping over the blocks before it without decoding them
+
+#include <aurora/LogBlock.hpp>
+
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <print>
+#include <string>
+#include <string_view>
+
+using namespace aurora;
+
+
+namespace {
+
+std::string formatTime(std::int64_t ns) {
+	namespace ch = std::chrono;
+
+	return std::format("{:%F %T}", ch::sys_time<ch::nanoseconds>(ch::nanoseconds(ns)));
+}
+
+int usage() noexcept {
+	std::println(stderr, "Usage: aurora-unpack <log file | -> [--list | --block <n>]");
+
+	return 2;
+}
+
+} // namespace
+
+
+int main(int argc, char** argv) {
+	if (argc < 2)
+		return usage();
+
+	std::string_view path = argv[1];
+	bool list = false;
+	std::optional<std::uint64_t> only;
+
+	for (int i = 2; i < argc; ++i) {
+		std::string_view arg = argv[i];
+
+		if (arg == "--list") {
+			list = true;
+		} else if (arg == "--block" && i + 1 < argc) {
+			std::string_view value = argv[++i];
+			std::uint64_t block;
+			if (std::from_chars(value.data(), value.data() + value.size(), block).ec != std::errc())
+				return usage();
+
+			only = block;
+		} else {
+			return usage();
+		}
+	}
+
+	std::ifstream F;
+	if (path != "-") {
+		F.open(std::string(path), std::ios::binary);
+		if (!F.is_open()) {
+			std::println(stderr, "Failed to open '{}'.", path);
+			return 1;
+		}
+	}
+	std::istream& stream = path == "-" ? std::cin : F;
+
+	std::string payload;
+	std::string records;
+	std::uint64_t offset = 0u;
+
+	for (std::uint64_t index = 0u; ; ++index) {
+		auto header = LogBlock::readHeader(stream);
+		if (!header) {
+			if (stream.gcount() != 0) {
+				std::println(stderr, "Invalid or truncated block header at offset {}.", offset);
+				return 1;
+			}
+			break;
+		}
+
+		bool wanted = !only || *only == index;
+
+		if (list) {
+			std::println(
+				"#{} @{}: {} record(s), {} - {}, {} -> {} bytes ({})",
+				index, offset, header->recordCount,
+				formatTime(header->firstTime), formatTime(header->lastTime),
+				header->rawSize, header->storedSize,
+				header->codec == LogBlock::Codec::LZ ? "lz" : "stored"
+			);
+		}
+
+		// blocks that aren't decoded are skipped over (seeking when possible)
+		if (list || !wanted) {
+			if (&stream == &F)
+				stream.seekg(header->storedSize, std::ios::cur);
+			else
+				stream.ignore(header->storedSize);
+		} else {
+			payload.resize(header->storedSize);
+			stream.read(payload.data(), static_cast<std::streamsize>(payload.size()));
+		}
+		if (!stream) {
+			std::println(stderr, "Truncated block #{} at offset {}.", index, offset);
+			return 1;
+		}
+
+		if (!list && wanted) {
+			if (!LogBlock::decode(*header, payload, records)) {
+				std::println(stderr, "Corrupted block #{} at offset {}.", index, offset);
+				return 1;
+			}
+
+			std::fwrite(records.data(), 1u, records.size(), stdout);
+		}
+
+		offset += sizeof(LogBlock::Header) + header->storedSize;
+
+		if (only && *only == index) {
+			std::fflush(stdout);
+			return 0;
+		}
+	}
+
+	std::fflush(stdout);
+
+	if (only) {
+		std::println(stderr, "No block #{}.", *only);
+		return 1;
+	}
+
+	return 0;
+}
\ No newline at end of file